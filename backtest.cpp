@@ -0,0 +1,1196 @@
+#include "backtest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <atomic>
+
+#define BACKTEST_BLOCK 1024 // bars per pass, keeps the scratch columns in L1
+
+static const double seconds_per_year = 365.25 * 86400.0;
+
+static double backtest_years(const lv_candles *candles) {
+    if (candles->size < 2) return 0.0;
+    return (double)(candles->timestamp[candles->size - 1] - candles->timestamp[0]) / seconds_per_year;
+}
+
+// The configured periods per year, else inferred from n samples spanning
+// years, else trading days.
+static double backtest_ppy(double configured, size_t n, double years) {
+    if (configured > 0.0) return configured;
+    return years > 0.0 ? (double)(n - 1) / years : 252.0;
+}
+
+static double backtest_periods(const lv_candles *candles, const lv_backtest_config *config) {
+    return backtest_ppy(config->periods_per_year, candles->size, backtest_years(candles));
+}
+
+// What every engine accumulates over a run of n period returns.
+typedef struct backtest_totals {
+    double growth;          // final equity over initial
+    double max_dd;
+    double sum, sum_sq;     // of the period returns
+    double traded;          // absolute exposure changes
+    size_t trades;
+} backtest_totals;
+
+static void backtest_stats_finish(const backtest_totals *t, size_t n, double years, double ppy, lv_backtest_stats *stats) {
+    const double mean = n ? t->sum / (double)n : 0.0;
+    const double var = n ? t->sum_sq / (double)n - mean * mean : 0.0;
+    stats->total_return = t->growth - 1.0;
+    stats->cagr = years > 0.0 && t->growth > 0.0 ? pow(t->growth, 1.0 / years) - 1.0 : 0.0;
+    stats->max_drawdown = t->max_dd;
+    stats->sharpe = var > 0.0 ? mean / sqrt(var) * sqrt(ppy) : 0.0;
+    stats->turnover = years > 0.0 ? t->traded / years : t->traded;
+    stats->trades = t->trades;
+}
+
+// Pass 1: net return and traded exposure of bars [first, last). Exposure held
+// through a bar is the position decided on an earlier close; with next-open
+// fills the gap from the previous close to the open is still carried by the
+// position before that. Costs are charged on the bar the trade happens. The
+// outputs never alias the inputs, which lets the compiler vectorize the loops.
+static void backtest_returns(const lv_candles *candles, const double *position, lv_fill fill, double cost,
+                             size_t first, size_t last, double *__restrict ret, double *__restrict traded) {
+    const double *open = candles->open, *close = candles->close;
+    size_t i = first;
+    if (fill == LV_FILL_CLOSE) {
+        if (i == 0 && i < last) {
+            traded[0] = fabs(position[0]);
+            ret[0] = -cost * traded[0];
+            i++;
+        }
+        for (; i < last; i++) {
+            double d = fabs(position[i] - position[i - 1]);
+            traded[i - first] = d;
+            ret[i - first] = position[i - 1] * (close[i] / close[i - 1] - 1.0) - cost * d;
+        }
+    } else {
+        for (; i < last && i < 2; i++) {
+            double held = i == 1 ? position[0] : 0.0;
+            traded[i - first] = fabs(held);
+            ret[i - first] = held * (close[i] / open[i] - 1.0) - cost * traded[i - first];
+        }
+        for (; i < last; i++) {
+            double before = position[i - 2], after = position[i - 1];
+            double d = fabs(after - before);
+            double gap = before * (open[i] / close[i - 1] - 1.0);
+            double session = after * (close[i] / open[i] - 1.0);
+            traded[i - first] = d;
+            ret[i - first] = (1.0 + gap) * (1.0 + session) - 1.0 - cost * d;
+        }
+    }
+}
+
+int lv_backtest_vector(const lv_candles *candles, const double *position, const lv_backtest_config *config,
+                       double *returns, double *equity, double *drawdown, lv_backtest_stats *stats) {
+    LV_TRACE_SPAN("lv_backtest_vector");
+    if (!candles || !position || !config || candles->size == 0) return -1;
+
+    const size_t n = candles->size;
+    const double cost = config->commission + config->slippage;
+    double ret_block[BACKTEST_BLOCK], traded_block[BACKTEST_BLOCK];
+    double eq = 1.0, peak = 1.0, max_dd = 0.0;
+    double sum = 0.0, sum_sq = 0.0, traded = 0.0;
+    size_t trades = 0;
+
+    for (size_t first = 0; first < n; first += BACKTEST_BLOCK) {
+        const size_t last = first + BACKTEST_BLOCK < n ? first + BACKTEST_BLOCK : n;
+        const size_t m = last - first;
+        double *ret = returns ? returns + first : ret_block;
+        backtest_returns(candles, position, config->fill, cost, first, last, ret, traded_block);
+
+        // Pass 2: moments and turnover. Four independent accumulators stand in
+        // for vector lanes; summing in order would serialise on the adds.
+        double acc[4] = {0.0, 0.0, 0.0, 0.0}, acc_sq[4] = {0.0, 0.0, 0.0, 0.0}, acc_traded[4] = {0.0, 0.0, 0.0, 0.0};
+        size_t k = 0;
+        for (; k + 4 <= m; k += 4) {
+            for (int j = 0; j < 4; j++) {
+                acc[j] += ret[k + j];
+                acc_sq[j] += ret[k + j] * ret[k + j];
+                acc_traded[j] += traded_block[k + j];
+                trades += traded_block[k + j] != 0.0;
+            }
+        }
+        for (; k < m; k++) {
+            acc[0] += ret[k];
+            acc_sq[0] += ret[k] * ret[k];
+            acc_traded[0] += traded_block[k];
+            trades += traded_block[k] != 0.0;
+        }
+        sum += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+        sum_sq += (acc_sq[0] + acc_sq[1]) + (acc_sq[2] + acc_sq[3]);
+        traded += (acc_traded[0] + acc_traded[1]) + (acc_traded[2] + acc_traded[3]);
+
+        // Pass 3: compounding and drawdown, the only serial dependency.
+        for (k = 0; k < m; k++) {
+            eq *= 1.0 + ret[k];
+            peak = eq > peak ? eq : peak;
+            double dd = 1.0 - eq / peak;
+            max_dd = dd > max_dd ? dd : max_dd;
+            if (equity) equity[first + k] = eq;
+            if (drawdown) drawdown[first + k] = dd;
+        }
+    }
+
+    if (stats) {
+        const backtest_totals totals = {eq, max_dd, sum, sum_sq, traded, trades};
+        backtest_stats_finish(&totals, n, backtest_years(candles), backtest_periods(candles, config), stats);
+    }
+    return 0;
+}
+
+#define ENGINE_NONE UINT32_MAX
+
+static inline uint64_t order_id(const lv_engine *engine, uint32_t slot) {
+    return ((uint64_t)engine->orders[slot].generation << 32) | (uint64_t)(slot + 1);
+}
+
+// Slot of a live order, or ENGINE_NONE for ids that were filled, cancelled or never issued.
+static uint32_t order_slot(const lv_engine *engine, uint64_t id) {
+    uint64_t slot = (id & 0xffffffffu) - 1;
+    if (id == 0 || slot >= engine->config.max_orders) return ENGINE_NONE;
+    const lv_order *o = &engine->orders[slot];
+    if (o->generation != (uint32_t)(id >> 32) || o->quantity == 0.0) return ENGINE_NONE;
+    return (uint32_t)slot;
+}
+
+static void order_release(lv_engine *engine, uint32_t slot) {
+    lv_order *o = &engine->orders[slot];
+    if (o->prev != ENGINE_NONE) engine->orders[o->prev].next = o->next;
+    else engine->working[o->series] = o->next;
+    if (o->next != ENGINE_NONE) engine->orders[o->next].prev = o->prev;
+    o->quantity = 0.0;
+    o->generation++;
+    o->next = engine->free_order;
+    engine->free_order = slot;
+}
+
+int lv_engine_init(lv_engine *engine, const lv_candles *series, size_t count, const lv_engine_config *config) {
+    if (!engine || !series || count == 0 || !config || config->max_orders == 0 || config->max_orders >= ENGINE_NONE) return -1;
+    size_t bars = 0;
+    for (size_t s = 0; s < count; s++) bars += series[s].size;
+    engine->series = series;
+    engine->count = count;
+    engine->config = *config;
+    engine->positions = (lv_position *)malloc(sizeof(lv_position) * count);
+    engine->orders = (lv_order *)malloc(sizeof(lv_order) * config->max_orders);
+    engine->working = (uint32_t *)malloc(sizeof(uint32_t) * count);
+    engine->touched = (uint64_t *)malloc(sizeof(uint64_t) * config->max_orders);
+    engine->touch_at = (double *)malloc(sizeof(double) * config->max_orders);
+    engine->pending = (uint64_t *)malloc(sizeof(uint64_t) * config->max_orders);
+    engine->heap = (size_t *)malloc(sizeof(size_t) * count);
+    engine->cursor = (size_t *)malloc(sizeof(size_t) * count);
+    engine->trades = (lv_trade *)malloc(sizeof(lv_trade) * (config->max_trades ? config->max_trades : 1));
+    engine->equity = (double *)malloc(sizeof(double) * (bars ? bars : 1));
+    engine->equity_time = (time_t *)malloc(sizeof(time_t) * (bars ? bars : 1));
+    engine->equity_cap = bars;
+    for (size_t i = 0; i < config->max_orders; i++) {
+        engine->orders[i].quantity = 0.0;
+        engine->orders[i].generation = 0;
+    }
+    return 0;
+}
+
+void lv_engine_free(lv_engine *engine) {
+    free(engine->positions);
+    free(engine->orders);
+    free(engine->working);
+    free(engine->touched);
+    free(engine->touch_at);
+    free(engine->pending);
+    free(engine->heap);
+    free(engine->cursor);
+    free(engine->trades);
+    free(engine->equity);
+    free(engine->equity_time);
+}
+
+// Drops pending ids that were cancelled before the close. Live ones are
+// bounded by the pool, so this always makes room for the order being added.
+static void pending_compact(lv_engine *engine) {
+    size_t n = 0;
+    for (size_t k = engine->pending_head; k < engine->pending_count; k++)
+        if (order_slot(engine, engine->pending[k]) != ENGINE_NONE) engine->pending[n++] = engine->pending[k];
+    engine->pending_head = 0;
+    engine->pending_count = n;
+}
+
+uint64_t lv_engine_submit(lv_engine *engine, size_t series, lv_order_type type, double quantity, double price) {
+    if (series >= engine->count || quantity == 0.0 || engine->free_order == ENGINE_NONE) return 0;
+    uint32_t slot = engine->free_order;
+    lv_order *o = &engine->orders[slot];
+    engine->free_order = o->next;
+    o->series = series;
+    o->type = type;
+    o->quantity = quantity;
+    o->price = price;
+    o->sequence = engine->sequence++;
+    o->prev = ENGINE_NONE;
+    o->next = engine->working[series];
+    if (o->next != ENGINE_NONE) engine->orders[o->next].prev = slot;
+    engine->working[series] = slot;
+    uint64_t id = order_id(engine, slot);
+    // A series that has printed a bar can fill at its close; otherwise the
+    // order waits for the open of its first bar like any other.
+    if (type == LV_ORDER_MARKET && engine->config.market_fill == LV_FILL_CLOSE && engine->cursor[series] > 0) {
+        if (engine->pending_count == engine->config.max_orders) pending_compact(engine);
+        engine->pending[engine->pending_count++] = id;
+    }
+    return id;
+}
+
+int lv_engine_modify(lv_engine *engine, uint64_t order, double price) {
+    uint32_t slot = order_slot(engine, order);
+    if (slot == ENGINE_NONE) return -1;
+    engine->orders[slot].price = price;
+    return 0;
+}
+
+int lv_engine_cancel(lv_engine *engine, uint64_t order) {
+    uint32_t slot = order_slot(engine, order);
+    if (slot == ENGINE_NONE) return -1;
+    order_release(engine, slot);
+    return 0;
+}
+
+double lv_engine_equity(const lv_engine *engine) {
+    return engine->cash + engine->market_value;
+}
+
+static void engine_fill(lv_engine *engine, const lv_strategy *strategy, uint32_t slot, size_t bar, double price) {
+    const lv_order *o = &engine->orders[slot];
+    const size_t s = o->series;
+    const double q = o->quantity;
+    if (o->type != LV_ORDER_LIMIT) price *= q > 0.0 ? 1.0 + engine->config.slippage : 1.0 - engine->config.slippage;
+    const double notional = fabs(q * price);
+    const double commission = notional * engine->config.commission;
+
+    lv_position *p = &engine->positions[s];
+    if (p->quantity == 0.0 || (p->quantity > 0.0) == (q > 0.0)) {
+        p->average_price = (p->average_price * fabs(p->quantity) + price * fabs(q)) / (fabs(p->quantity) + fabs(q));
+    } else {
+        double closed = fabs(q) < fabs(p->quantity) ? fabs(q) : fabs(p->quantity);
+        p->realized += closed * (price - p->average_price) * (p->quantity > 0.0 ? 1.0 : -1.0);
+        if (fabs(q) > fabs(p->quantity)) p->average_price = price;
+        else if (fabs(q) == fabs(p->quantity)) p->average_price = 0.0;
+    }
+    const double equity = lv_engine_equity(engine);
+    p->realized -= commission;
+    p->quantity += q;
+    engine->cash -= q * price + commission;
+    engine->market_value += q * p->last;
+    engine->traded += equity > 0.0 ? notional / equity : 0.0;
+
+    lv_trade trade = {order_id(engine, slot), s, bar, q, price, commission};
+    if (engine->trade_count < engine->config.max_trades) engine->trades[engine->trade_count] = trade;
+    engine->trade_count++;
+    order_release(engine, slot);
+    if (strategy->on_fill) strategy->on_fill(engine, &trade, strategy->user);
+}
+
+// Distance along open -> first extreme -> second extreme -> close at which the
+// price first reaches level from below (up) or above (!up); negative if never.
+// *at receives the fill price: the open when it already gapped through.
+static double path_touch(const double *path, bool up, double level, double *at) {
+    if (up ? path[0] >= level : path[0] <= level) {
+        *at = path[0];
+        return 0.0;
+    }
+    double travelled = 0.0;
+    for (int k = 0; k < 3; k++) {
+        double a = path[k], b = path[k + 1];
+        if (up ? b >= level : b <= level) {
+            *at = level;
+            return travelled + fabs(level - a);
+        }
+        travelled += fabs(b - a);
+    }
+    return -1.0;
+}
+
+// Triggers the working orders of series s against bar i, in the order the
+// assumed path reaches them. Fill hooks may cancel orders that triggered
+// later in the same bar (one-cancels-other), so each is re-checked.
+static void engine_match(lv_engine *engine, const lv_strategy *strategy, size_t s, size_t i) {
+    const lv_candles *c = &engine->series[s];
+    const double o = c->open[i], h = c->high[i], l = c->low[i];
+    bool high_first;
+    switch (engine->config.path) {
+    case LV_PATH_HIGH_FIRST: high_first = true; break;
+    case LV_PATH_LOW_FIRST:  high_first = false; break;
+    default:                 high_first = h - o < o - l; break;
+    }
+    const double path[4] = {o, high_first ? h : l, high_first ? l : h, c->close[i]};
+
+    size_t n = 0;
+    for (uint32_t slot = engine->working[s]; slot != ENGINE_NONE; slot = engine->orders[slot].next) {
+        const lv_order *ord = &engine->orders[slot];
+        const bool buy = ord->quantity > 0.0;
+        double at, t;
+        switch (ord->type) {
+        case LV_ORDER_MARKET: t = 0.0; break;
+        case LV_ORDER_LIMIT:  t = path_touch(path, !buy, ord->price, &at); break;
+        default:              t = path_touch(path, buy, ord->price, &at); break;
+        }
+        if (t < 0.0) continue;
+        // insertion by (distance, sequence); few orders trigger per bar
+        size_t k = n++;
+        while (k > 0 && (engine->touch_at[k - 1] > t ||
+                         (engine->touch_at[k - 1] == t && engine->orders[(engine->touched[k - 1] & 0xffffffffu) - 1].sequence > ord->sequence))) {
+            engine->touched[k] = engine->touched[k - 1];
+            engine->touch_at[k] = engine->touch_at[k - 1];
+            k--;
+        }
+        engine->touched[k] = order_id(engine, slot);
+        engine->touch_at[k] = t;
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        uint32_t slot = order_slot(engine, engine->touched[k]);
+        if (slot == ENGINE_NONE) continue;
+        const lv_order *ord = &engine->orders[slot];
+        double at = o;
+        if (ord->type != LV_ORDER_MARKET)
+            path_touch(path, (ord->quantity > 0.0) == (ord->type == LV_ORDER_STOP), ord->price, &at);
+        engine_fill(engine, strategy, slot, i, at);
+    }
+}
+
+// Market orders placed while LV_FILL_CLOSE is in effect fill at the latest
+// close of their series. Hooks run from here may queue more.
+static void engine_drain(lv_engine *engine, const lv_strategy *strategy) {
+    while (engine->pending_head < engine->pending_count) {
+        uint32_t slot = order_slot(engine, engine->pending[engine->pending_head++]);
+        if (slot == ENGINE_NONE) continue;
+        const size_t s = engine->orders[slot].series;
+        engine_fill(engine, strategy, slot, engine->cursor[s] - 1, engine->positions[s].last);
+    }
+    engine->pending_head = 0;
+    engine->pending_count = 0;
+}
+
+static inline bool heap_before(const lv_engine *engine, size_t a, size_t b) {
+    time_t ta = engine->series[a].timestamp[engine->cursor[a]];
+    time_t tb = engine->series[b].timestamp[engine->cursor[b]];
+    return ta < tb || (ta == tb && a < b);
+}
+
+static void heap_sift_down(lv_engine *engine, size_t i) {
+    size_t *heap = engine->heap;
+    for (;;) {
+        size_t l = 2 * i + 1, best = i;
+        if (l < engine->heap_size && heap_before(engine, heap[l], heap[best])) best = l;
+        if (l + 1 < engine->heap_size && heap_before(engine, heap[l + 1], heap[best])) best = l + 1;
+        if (best == i) return;
+        size_t tmp = heap[i];
+        heap[i] = heap[best];
+        heap[best] = tmp;
+        i = best;
+    }
+}
+
+static void engine_reset(lv_engine *engine) {
+    const size_t max_orders = engine->config.max_orders;
+    for (size_t i = 0; i < max_orders; i++) {
+        lv_order *o = &engine->orders[i];
+        if (o->quantity != 0.0) o->generation++;
+        o->quantity = 0.0;
+        o->next = i + 1 < max_orders ? (uint32_t)(i + 1) : ENGINE_NONE;
+    }
+    engine->free_order = 0;
+    engine->sequence = 0;
+    engine->pending_head = 0;
+    engine->pending_count = 0;
+    engine->heap_size = 0;
+    for (size_t s = 0; s < engine->count; s++) {
+        lv_position empty = {0.0, 0.0, 0.0, 0.0};
+        engine->positions[s] = empty;
+        engine->working[s] = ENGINE_NONE;
+        engine->cursor[s] = 0;
+        if (engine->series[s].size > 0) engine->heap[engine->heap_size++] = s;
+    }
+    for (size_t i = engine->heap_size; i-- > 0;) heap_sift_down(engine, i);
+    engine->trade_count = 0;
+    engine->equity_count = 0;
+    engine->cash = engine->config.initial_cash;
+    engine->market_value = 0.0;
+    engine->traded = 0.0;
+}
+
+int lv_engine_run(lv_engine *engine, const lv_strategy *strategy, lv_backtest_stats *stats) {
+    LV_TRACE_SPAN("lv_engine_run");
+    if (!engine || !strategy || engine->config.initial_cash <= 0.0) return -1;
+    engine_reset(engine);
+    if (strategy->on_start) strategy->on_start(engine, strategy->user);
+
+    double peak = engine->cash, max_dd = 0.0, sum = 0.0, sum_sq = 0.0;
+    while (engine->heap_size > 0) {
+        const size_t s = engine->heap[0];
+        const lv_candles *c = &engine->series[s];
+        const size_t i = engine->cursor[s];
+        const time_t now = c->timestamp[i];
+
+        engine_match(engine, strategy, s, i);
+        lv_position *p = &engine->positions[s];
+        engine->market_value += p->quantity * (c->close[i] - p->last);
+        p->last = c->close[i];
+        engine->cursor[s] = i + 1;
+        if (strategy->on_bar) strategy->on_bar(engine, s, i, strategy->user);
+        engine_drain(engine, strategy);
+
+        if (i + 1 < c->size) {
+            heap_sift_down(engine, 0);
+        } else {
+            engine->heap[0] = engine->heap[--engine->heap_size];
+            heap_sift_down(engine, 0);
+        }
+
+        // One equity sample per timestamp, once every series at it is done.
+        if (engine->heap_size == 0 || engine->series[engine->heap[0]].timestamp[engine->cursor[engine->heap[0]]] != now) {
+            const double eq = lv_engine_equity(engine);
+            const double prev = engine->equity_count ? engine->equity[engine->equity_count - 1] : engine->config.initial_cash;
+            const double r = prev != 0.0 ? eq / prev - 1.0 : 0.0;
+            sum += r;
+            sum_sq += r * r;
+            peak = eq > peak ? eq : peak;
+            max_dd = peak > 0.0 && 1.0 - eq / peak > max_dd ? 1.0 - eq / peak : max_dd;
+            engine->equity[engine->equity_count] = eq;
+            engine->equity_time[engine->equity_count++] = now;
+        }
+    }
+
+    if (stats) {
+        const size_t n = engine->equity_count;
+        const double growth = n ? engine->equity[n - 1] / engine->config.initial_cash : 1.0;
+        const double years = n > 1 ? (double)(engine->equity_time[n - 1] - engine->equity_time[0]) / seconds_per_year : 0.0;
+        const backtest_totals totals = {growth, max_dd, sum, sum_sq, engine->traded, engine->trade_count};
+        backtest_stats_finish(&totals, n, years, backtest_ppy(0.0, n, years), stats);
+    }
+    return 0;
+}
+
+#define SWEEP_MAX_THREADS 64
+
+int lv_sweep_table_init(lv_sweep_table *table, size_t params, size_t symbols) {
+    const size_t rows = params * symbols;
+    if (!table || rows == 0 || rows > UINT32_MAX) return -1;
+    table->params = params;
+    table->symbols = symbols;
+    table->total_return = (double *)malloc(sizeof(double) * rows);
+    table->cagr = (double *)malloc(sizeof(double) * rows);
+    table->max_drawdown = (double *)malloc(sizeof(double) * rows);
+    table->sharpe = (double *)malloc(sizeof(double) * rows);
+    table->turnover = (double *)malloc(sizeof(double) * rows);
+    table->trades = (uint32_t *)malloc(sizeof(uint32_t) * rows);
+    table->done = (unsigned char *)calloc(rows, 1);
+    return 0;
+}
+
+void lv_sweep_table_free(lv_sweep_table *table) {
+    free(table->total_return);
+    free(table->cagr);
+    free(table->max_drawdown);
+    free(table->sharpe);
+    free(table->turnover);
+    free(table->trades);
+    free(table->done);
+}
+
+int lv_sweep_row_done(const lv_sweep_table *table, size_t row) {
+    return __atomic_load_n(&table->done[row], __ATOMIC_ACQUIRE);
+}
+
+// A thread's remaining jobs [begin, end), packed as begin << 32 | end so the
+// owner taking one job and a thief taking half are both a single CAS. Job
+// indices are handed out once, so a packed value never comes back (no ABA).
+// Padded so owners hammering their own range do not share cache lines.
+struct sweep_range {
+    std::atomic<uint64_t> jobs;
+    char pad[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+struct sweep_thread {
+    lv_sweep *sweep;
+    int index;
+    pthread_t tid;
+};
+
+struct lv_sweep {
+    lv_sweep_config config;
+    lv_sweep_table *table;
+    int threads;
+    sweep_range ranges[SWEEP_MAX_THREADS];
+    sweep_thread workers[SWEEP_MAX_THREADS];
+    double *scratch;
+    std::atomic<size_t> completed;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> ready;        // ranges are set up for the threads that started
+};
+
+static inline uint64_t sweep_pack(uint64_t begin, uint64_t end) { return begin << 32 | end; }
+
+static bool sweep_take(sweep_range *r, size_t *job) {
+    uint64_t v = r->jobs.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t begin = v >> 32, end = v & 0xffffffffu;
+        if (begin >= end) return false;
+        if (r->jobs.compare_exchange_weak(v, sweep_pack(begin + 1, end), std::memory_order_relaxed)) {
+            *job = (size_t)begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of another thread's range into self's (empty) one.
+static bool sweep_steal(lv_sweep *sweep, int self) {
+    for (int k = 1; k < sweep->threads; k++) {
+        sweep_range *victim = &sweep->ranges[(self + k) % sweep->threads];
+        uint64_t v = victim->jobs.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t begin = v >> 32, end = v & 0xffffffffu;
+            if (begin >= end) break;
+            uint64_t mid = end - (end - begin + 1) / 2;
+            if (victim->jobs.compare_exchange_weak(v, sweep_pack(begin, mid), std::memory_order_relaxed)) {
+                sweep->ranges[self].jobs.store(sweep_pack(mid, end), std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void sweep_run_job(lv_sweep *sweep, size_t job, double *scratch) {
+    lv_sweep_table *t = sweep->table;
+    const size_t symbol = job / t->params, param = job % t->params;
+    const size_t row = param * t->symbols + symbol;
+    lv_backtest_stats stats;
+    if (sweep->config.job(sweep->config.user, param, symbol, scratch, &stats) != 0) {
+        stats.total_return = stats.cagr = stats.max_drawdown = stats.sharpe = stats.turnover = NAN;
+        stats.trades = 0;
+    }
+    t->total_return[row] = stats.total_return;
+    t->cagr[row] = stats.cagr;
+    t->max_drawdown[row] = stats.max_drawdown;
+    t->sharpe[row] = stats.sharpe;
+    t->turnover[row] = stats.turnover;
+    t->trades[row] = stats.trades > UINT32_MAX ? UINT32_MAX : (uint32_t)stats.trades;
+    __atomic_store_n(&t->done[row], 1, __ATOMIC_RELEASE);
+    sweep->completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void * sweep_worker(void *arg) {
+    sweep_thread *w = (sweep_thread *)arg;
+    lv_sweep *sweep = w->sweep;
+    double *scratch = sweep->scratch + sweep->config.scratch * (size_t)w->index;
+    size_t job;
+    while (!sweep->ready.load(std::memory_order_acquire))
+        sched_yield();
+    while (!sweep->cancelled.load(std::memory_order_relaxed)) {
+        if (sweep_take(&sweep->ranges[w->index], &job))
+            sweep_run_job(sweep, job, scratch);
+        else if (!sweep_steal(sweep, w->index))
+            break;
+    }
+    return NULL;
+}
+
+lv_sweep *lv_sweep_start(const lv_sweep_config *config, lv_sweep_table *table) {
+    if (!config || !config->job || !table) return NULL;
+    const size_t jobs = table->params * table->symbols;
+    long cpus = config->threads > 0 ? config->threads : sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = (int)(cpus > 0 ? cpus : 1);
+    if (threads > SWEEP_MAX_THREADS) threads = SWEEP_MAX_THREADS;
+    if ((size_t)threads > jobs) threads = (int)jobs;
+
+    lv_sweep *sweep = new lv_sweep;
+    sweep->config = *config;
+    sweep->table = table;
+    sweep->threads = threads;
+    sweep->scratch = (double *)malloc(sizeof(double) * (config->scratch ? config->scratch : 1) * (size_t)threads);
+    sweep->completed.store(0);
+    sweep->cancelled.store(false);
+    sweep->ready.store(false);
+    memset(table->done, 0, jobs);
+    for (int t = 0; t < threads; t++) {
+        sweep->workers[t].sweep = sweep;
+        sweep->workers[t].index = t;
+        if (pthread_create(&sweep->workers[t].tid, NULL, sweep_worker, &sweep->workers[t]) != 0) {
+            sweep->threads = threads = t;
+            break;
+        }
+    }
+    if (threads == 0) {
+        free(sweep->scratch);
+        delete sweep;
+        return NULL;
+    }
+    // Split once the thread count is final, then let the workers go.
+    for (int t = 0; t < threads; t++) {
+        uint64_t begin = jobs * (size_t)t / (size_t)threads, end = jobs * (size_t)(t + 1) / (size_t)threads;
+        sweep->ranges[t].jobs.store(sweep_pack(begin, end), std::memory_order_relaxed);
+    }
+    sweep->ready.store(true, std::memory_order_release);
+    return sweep;
+}
+
+size_t lv_sweep_progress(const lv_sweep *sweep) {
+    return sweep->completed.load(std::memory_order_relaxed);
+}
+
+void lv_sweep_cancel(lv_sweep *sweep) {
+    sweep->cancelled.store(true, std::memory_order_relaxed);
+}
+
+int lv_sweep_wait(lv_sweep *sweep) {
+    for (int t = 0; t < sweep->threads; t++)
+        pthread_join(sweep->workers[t].tid, NULL);
+    int result = sweep->cancelled.load() ? -1 : 0;
+    free(sweep->scratch);
+    delete sweep;
+    return result;
+}
+
+// Runs jobs [0, jobs) on the sweep pool and waits for them; the jobs keep
+// their results in user, the table only tracks completion.
+static int sweep_blocking(lv_sweep_job job, void *user, size_t jobs, size_t scratch, int threads) {
+    lv_sweep_table table;
+    if (lv_sweep_table_init(&table, jobs, 1) != 0) return -1;
+    lv_sweep_config config = {job, user, scratch, threads};
+    lv_sweep *sweep = lv_sweep_start(&config, &table);
+    int rc = sweep ? lv_sweep_wait(sweep) : -1;
+    lv_sweep_table_free(&table);
+    return rc;
+}
+
+// Window edges are the sorted, distinct train window bounds. sum and sum_sq
+// hold running sums of each parameter set's net returns up to every edge,
+// edge-major, so selecting a fold reads two contiguous rows.
+struct walkforward {
+    const lv_candles *candles;
+    const lv_walkforward_config *config;
+    lv_walkforward_result *result;
+    size_t *edges;
+    size_t edge_count;
+    size_t *train_first;        // per fold, index into edges
+    size_t *train_last;
+    double *sum;
+    double *sum_sq;
+    unsigned char *usable;
+    double periods;
+};
+
+static int edge_compare(const void *a, const void *b) {
+    size_t x = *(const size_t *)a, y = *(const size_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static size_t edge_find(const walkforward *wf, size_t bar) {
+    size_t lo = 0, hi = wf->edge_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (wf->edges[mid] < bar) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// One pass over the whole series per parameter set, whatever the fold count.
+static int walkforward_param(void *user, size_t param, size_t symbol, double *scratch, lv_backtest_stats *stats) {
+    (void)symbol;
+    walkforward *wf = (walkforward *)user;
+    const size_t n = wf->candles->size, params = wf->config->params;
+    double *position = scratch, *ret = scratch + n;
+    if (wf->config->positions(wf->config->user, param, 0, n, position) != 0) {
+        wf->usable[param] = 0;
+        return -1;
+    }
+    lv_backtest_vector(wf->candles, position, &wf->config->backtest, ret, NULL, NULL, stats);
+    double s = 0.0, s2 = 0.0;
+    size_t e = 0;
+    for (size_t i = 0; i < n && e < wf->edge_count; i++) {
+        if (wf->edges[e] == i) {
+            wf->sum[e * params + param] = s;
+            wf->sum_sq[e * params + param] = s2;
+            e++;
+        }
+        s += ret[i];
+        s2 += ret[i] * ret[i];
+    }
+    wf->usable[param] = 1;
+    return 0;
+}
+
+static int walkforward_fold(void *user, size_t fold, size_t symbol, double *scratch, lv_backtest_stats *stats) {
+    (void)symbol; (void)scratch;
+    walkforward *wf = (walkforward *)user;
+    const size_t params = wf->config->params;
+    const double len = (double)wf->config->train;
+    const double *s0 = wf->sum + wf->train_first[fold] * params, *s1 = wf->sum + wf->train_last[fold] * params;
+    const double *q0 = wf->sum_sq + wf->train_first[fold] * params, *q1 = wf->sum_sq + wf->train_last[fold] * params;
+    size_t chosen = params;
+    double best = -INFINITY;
+    for (size_t p = 0; p < params; p++) {
+        if (!wf->usable[p]) continue;
+        const double mean = (s1[p] - s0[p]) / len;
+        const double var = (q1[p] - q0[p]) / len - mean * mean;
+        const double sharpe = var > 0.0 ? mean / sqrt(var) : 0.0;
+        if (sharpe > best) {
+            best = sharpe;
+            chosen = p;
+        }
+    }
+    wf->result->chosen[fold] = chosen;
+    wf->result->train_sharpe[fold] = chosen < params ? best * sqrt(wf->periods) : 0.0;
+    memset(stats, 0, sizeof(*stats));
+    return 0;
+}
+
+int lv_walkforward(const lv_candles *candles, const lv_walkforward_config *config, lv_walkforward_result *result) {
+    LV_TRACE_SPAN("lv_walkforward");
+    if (!candles || !config || !result || !config->positions || config->params == 0 || config->train == 0 ||
+        config->test == 0 || candles->size <= config->train)
+        return -1;
+
+    const size_t n = candles->size, params = config->params;
+    const size_t folds = (n - config->train + config->test - 1) / config->test;
+    memset(result, 0, sizeof(*result));
+    result->folds = folds;
+    result->first = config->train;
+    result->chosen = (size_t *)malloc(sizeof(size_t) * folds);
+    result->train_sharpe = (double *)malloc(sizeof(double) * folds);
+    result->test_return = (double *)malloc(sizeof(double) * folds);
+    result->equity = (double *)malloc(sizeof(double) * (n - config->train));
+
+    walkforward wf;
+    wf.candles = candles;
+    wf.config = config;
+    wf.result = result;
+    wf.periods = backtest_periods(candles, &config->backtest);
+    wf.edges = (size_t *)malloc(sizeof(size_t) * 2 * folds);
+    for (size_t k = 0; k < folds; k++) {
+        wf.edges[2 * k] = k * config->test;
+        wf.edges[2 * k + 1] = k * config->test + config->train;
+    }
+    qsort(wf.edges, 2 * folds, sizeof(size_t), edge_compare);
+    wf.edge_count = 0;
+    for (size_t k = 0; k < 2 * folds; k++)
+        if (wf.edge_count == 0 || wf.edges[wf.edge_count - 1] != wf.edges[k])
+            wf.edges[wf.edge_count++] = wf.edges[k];
+    wf.train_first = (size_t *)malloc(sizeof(size_t) * folds);
+    wf.train_last = (size_t *)malloc(sizeof(size_t) * folds);
+    for (size_t k = 0; k < folds; k++) {
+        wf.train_first[k] = edge_find(&wf, k * config->test);
+        wf.train_last[k] = edge_find(&wf, k * config->test + config->train);
+    }
+    wf.sum = (double *)malloc(sizeof(double) * wf.edge_count * params);
+    wf.sum_sq = (double *)malloc(sizeof(double) * wf.edge_count * params);
+    wf.usable = (unsigned char *)calloc(params, 1);
+
+    int rc = sweep_blocking(walkforward_param, &wf, params, 2 * n, config->threads);
+    if (rc == 0) rc = sweep_blocking(walkforward_fold, &wf, folds, 0, config->threads);
+
+    // Stitch: each test window trades the positions of its fold's choice,
+    // replayed from flat at the first out-of-sample bar so the switches
+    // between folds pay their costs like any other trade.
+    double *position = rc == 0 ? (double *)calloc(n, sizeof(double)) : NULL;
+    if (position) {
+        for (size_t k = 0; k < folds; k++) {
+            const size_t first = config->train + k * config->test;
+            const size_t last = first + config->test < n ? first + config->test : n;
+            if (result->chosen[k] < params &&
+                config->positions(config->user, result->chosen[k], first, last, position) != 0)
+                memset(position + first, 0, sizeof(double) * (last - first));
+        }
+        const size_t first = config->train;
+        lv_candles oos = *candles;
+        oos.timestamp += first;
+        oos.open += first;
+        oos.high += first;
+        oos.low += first;
+        oos.close += first;
+        oos.volume += first;
+        oos.size = n - first;
+        lv_backtest_vector(&oos, position + first, &config->backtest, NULL, result->equity, NULL, &result->stats);
+        for (size_t k = 0; k < folds; k++) {
+            const size_t begin = k * config->test;
+            const size_t end = begin + config->test < oos.size ? begin + config->test : oos.size;
+            const double before = begin > 0 ? result->equity[begin - 1] : 1.0;
+            result->test_return[k] = result->equity[end - 1] / before - 1.0;
+        }
+    } else {
+        rc = -1;
+    }
+
+    free(position);
+    free(wf.edges);
+    free(wf.train_first);
+    free(wf.train_last);
+    free(wf.sum);
+    free(wf.sum_sq);
+    free(wf.usable);
+    if (rc != 0) lv_walkforward_free(result);
+    return rc;
+}
+
+void lv_walkforward_free(lv_walkforward_result *result) {
+    free(result->chosen);
+    free(result->train_sharpe);
+    free(result->test_return);
+    free(result->equity);
+    memset(result, 0, sizeof(*result));
+}
+
+#define BOOTSTRAP_CHUNK 256     // block starts or paths per job
+#define BOOTSTRAP_LANES 8       // paths advanced together, independent chains for the core to overlap
+#define BOOTSTRAP_BINS  16384
+
+// Fixed-width buckets over [lo, hi]; values outside land in the end buckets.
+struct bootstrap_sketch {
+    double lo;
+    double width;
+    uint64_t *count;
+};
+
+static void sketch_add(bootstrap_sketch *sk, double value) {
+    double at = (value - sk->lo) / sk->width;
+    size_t bin = at <= 0.0 ? 0 : at >= BOOTSTRAP_BINS - 1 ? BOOTSTRAP_BINS - 1 : (size_t)at;
+    __atomic_fetch_add(&sk->count[bin], 1, __ATOMIC_RELAXED);
+}
+
+// Interpolates within the bucket holding rank q * (total - 1).
+static double sketch_quantile(const bootstrap_sketch *sk, uint64_t total, double q) {
+    const double rank = (q < 0.0 ? 0.0 : q > 1.0 ? 1.0 : q) * (double)(total - 1);
+    uint64_t below = 0;
+    for (size_t bin = 0; bin < BOOTSTRAP_BINS; bin++) {
+        const uint64_t c = sk->count[bin];
+        if (c && rank < (double)(below + c)) {
+            const double within = c > 1 ? (rank - (double)below) / (double)(c - 1) : 0.5;
+            return sk->lo + ((double)bin + (within < 1.0 ? within : 1.0)) * sk->width;
+        }
+        below += c;
+    }
+    return sk->lo + BOOTSTRAP_BINS * sk->width;
+}
+
+static inline uint64_t bootstrap_mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Paths work in log growth, where a block is summarised by its sum, the
+// highest and lowest partial sums and its deepest fall from a running peak.
+// Those combine associatively, so a path costs one gather per block rather
+// than one step per return:
+//   drawdown(A B) = min(drawdown A, drawdown B, sum A - peak A + trough B)
+struct bootstrap {
+    const lv_bootstrap_config *config;
+    double *growth;             // log(1 + r) per input return
+    size_t n;
+    size_t block;
+    size_t draws;               // blocks per path
+    double *sum;                // per block start
+    double *peak;
+    double *trough;
+    double *drawdown;
+    bootstrap_sketch total;     // of the path's log growth
+    bootstrap_sketch fall;      // of the max drawdown, as a fraction
+    uint64_t losses;
+};
+
+static int bootstrap_blocks(void *user, size_t job, size_t symbol, double *scratch, lv_backtest_stats *stats) {
+    (void)symbol; (void)scratch;
+    bootstrap *b = (bootstrap *)user;
+    const size_t first = job * BOOTSTRAP_CHUNK, last = first + BOOTSTRAP_CHUNK < b->n ? first + BOOTSTRAP_CHUNK : b->n;
+    for (size_t s = first; s < last; s++) {
+        double cum = 0.0, peak = 0.0, trough = 0.0, dd = 0.0;
+        for (size_t j = 0, i = s; j < b->block; j++, i = i + 1 < b->n ? i + 1 : 0) {
+            cum += b->growth[i];
+            peak = cum > peak ? cum : peak;
+            trough = cum < trough ? cum : trough;
+            dd = cum - peak < dd ? cum - peak : dd;
+        }
+        b->sum[s] = cum;
+        b->peak[s] = peak;
+        b->trough[s] = trough;
+        b->drawdown[s] = dd;
+    }
+    memset(stats, 0, sizeof(*stats));
+    return 0;
+}
+
+static int bootstrap_paths(void *user, size_t job, size_t symbol, double *scratch, lv_backtest_stats *stats) {
+    (void)symbol; (void)scratch;
+    bootstrap *b = (bootstrap *)user;
+    const size_t first = job * BOOTSTRAP_CHUNK;
+    const size_t last = first + BOOTSTRAP_CHUNK < b->config->paths ? first + BOOTSTRAP_CHUNK : b->config->paths;
+    const double *sum = b->sum, *peak = b->peak, *trough = b->trough, *drawdown = b->drawdown;
+    uint64_t losses = 0;
+    for (size_t p = first; p < last; p += BOOTSTRAP_LANES) {
+        uint64_t key[BOOTSTRAP_LANES];
+        double total[BOOTSTRAP_LANES], high[BOOTSTRAP_LANES], fall[BOOTSTRAP_LANES];
+        for (int l = 0; l < BOOTSTRAP_LANES; l++) {
+            key[l] = bootstrap_mix(b->config->seed ^ bootstrap_mix(p + (size_t)l));
+            total[l] = high[l] = fall[l] = 0.0;
+        }
+        for (uint64_t j = 1; j <= b->draws; j++) {
+            for (int l = 0; l < BOOTSTRAP_LANES; l++) {
+                const uint64_t r = bootstrap_mix(key[l] + j * 0x9e3779b97f4a7c15ull);
+                const size_t s = (size_t)(((unsigned __int128)r * b->n) >> 64);
+                const double across = total[l] - high[l] + trough[s];
+                const double f = drawdown[s] < across ? drawdown[s] : across;
+                const double h = total[l] + peak[s];
+                fall[l] = f < fall[l] ? f : fall[l];
+                high[l] = h > high[l] ? h : high[l];
+                total[l] += sum[s];
+            }
+        }
+        for (size_t l = 0; l < BOOTSTRAP_LANES && p + l < last; l++) {
+            sketch_add(&b->total, total[l]);
+            sketch_add(&b->fall, 1.0 - exp(fall[l]));
+            losses += total[l] < 0.0;
+        }
+    }
+    __atomic_fetch_add(&b->losses, losses, __ATOMIC_RELAXED);
+    memset(stats, 0, sizeof(*stats));
+    return 0;
+}
+
+int lv_bootstrap(size_t sz, const double *returns, const lv_bootstrap_config *config, lv_bootstrap_result *result) {
+    LV_TRACE_SPAN("lv_bootstrap");
+    if (!returns || !config || !result || sz == 0 || config->paths == 0 || config->block == 0 ||
+        (config->quantile_count && !config->quantiles))
+        return -1;
+
+    bootstrap b;
+    b.config = config;
+    b.n = sz;
+    b.block = config->block < sz ? config->block : sz;
+    b.draws = ((config->length ? config->length : sz) + b.block - 1) / b.block;
+    b.losses = 0;
+    b.growth = (double *)malloc(sizeof(double) * sz);
+    for (size_t i = 0; i < sz; i++)
+        // a total loss leaves a path at (nearly) nothing rather than undefined
+        b.growth[i] = log(returns[i] > -1.0 ? 1.0 + returns[i] : 1e-300);
+    b.sum = (double *)malloc(sizeof(double) * sz);
+    b.peak = (double *)malloc(sizeof(double) * sz);
+    b.trough = (double *)malloc(sizeof(double) * sz);
+    b.drawdown = (double *)malloc(sizeof(double) * sz);
+    b.total.count = (uint64_t *)calloc(BOOTSTRAP_BINS, sizeof(uint64_t));
+    b.fall.count = (uint64_t *)calloc(BOOTSTRAP_BINS, sizeof(uint64_t));
+    b.fall.lo = 0.0;
+    b.fall.width = 1.0 / BOOTSTRAP_BINS;
+    const double length = (double)(b.draws * b.block);
+
+    int rc = sweep_blocking(bootstrap_blocks, &b, (sz + BOOTSTRAP_CHUNK - 1) / BOOTSTRAP_CHUNK, 0, config->threads);
+    if (rc == 0) {
+        // A path's growth is a sum of draws independent block sums, so its
+        // mean and spread follow from theirs; sixteen deviations either side
+        // keep the clipped tails far beyond any quantile of interest.
+        double mean = 0.0, var = 0.0;
+        for (size_t s = 0; s < sz; s++)
+            mean += b.sum[s];
+        mean /= (double)sz;
+        for (size_t s = 0; s < sz; s++)
+            var += (b.sum[s] - mean) * (b.sum[s] - mean);
+        var /= (double)sz;
+        const double spread = 16.0 * sqrt((double)b.draws * var) + 1e-9;
+        b.total.lo = (double)b.draws * mean - spread;
+        b.total.width = 2.0 * spread / BOOTSTRAP_BINS;
+    }
+    if (rc == 0)
+        rc = sweep_blocking(bootstrap_paths, &b, (config->paths + BOOTSTRAP_CHUNK - 1) / BOOTSTRAP_CHUNK, 0, config->threads);
+
+    if (rc == 0) {
+        const size_t q = config->quantile_count;
+        const double ppy = config->periods_per_year > 0.0 ? config->periods_per_year : 252.0;
+        result->paths = config->paths;
+        result->length = b.draws * b.block;
+        result->total_return = (double *)malloc(sizeof(double) * (q ? q : 1));
+        result->cagr = (double *)malloc(sizeof(double) * (q ? q : 1));
+        result->max_drawdown = (double *)malloc(sizeof(double) * (q ? q : 1));
+        result->loss_probability = (double)b.losses / (double)config->paths;
+        // CAGR is monotonic in total growth, so its quantiles map across.
+        for (size_t k = 0; k < q; k++) {
+            const double g = sketch_quantile(&b.total, config->paths, config->quantiles[k]);
+            result->total_return[k] = expm1(g);
+            result->cagr[k] = expm1(g * ppy / length);
+            result->max_drawdown[k] = sketch_quantile(&b.fall, config->paths, config->quantiles[k]);
+        }
+    }
+
+    free(b.growth);
+    free(b.total.count);
+    free(b.fall.count);
+    free(b.sum);
+    free(b.peak);
+    free(b.trough);
+    free(b.drawdown);
+    return rc;
+}
+
+void lv_bootstrap_free(lv_bootstrap_result *result) {
+    free(result->total_return);
+    free(result->cagr);
+    free(result->max_drawdown);
+    memset(result, 0, sizeof(*result));
+}
+
+size_t lv_trade_returns(size_t sz, const double *returns, const double *held, double *ou) {
+    size_t count = 0;
+    double growth = 1.0;
+    for (size_t i = 0; i < sz; i++) {
+        if (i > 0 && held[i] != held[i - 1] && held[i - 1] != 0.0) {
+            ou[count++] = growth - 1.0;
+            growth = 1.0;
+        }
+        growth *= 1.0 + returns[i];
+    }
+    if (sz > 0 && held[sz - 1] != 0.0)
+        ou[count++] = growth - 1.0;
+    return count;
+}
+
+// The union grows one series at a time by a linear merge, so building it is
+// O(count * size) with no sort and no copy of the price columns.
+int lv_timeline_init(lv_timeline *timeline, const lv_candles *series, size_t count) {
+    LV_TRACE_SPAN("lv_timeline_init");
+    if (!timeline || !series || count == 0) return -1;
+    for (size_t s = 0; s < count; s++)
+        if (series[s].size >= LV_TIMELINE_NONE) return -1;
+
+    time_t *axis = NULL, *merged = NULL;
+    size_t size = 0;
+    for (size_t s = 0; s < count; s++) {
+        const time_t *ts = series[s].timestamp;
+        const size_t n = series[s].size;
+        merged = (time_t *)realloc(merged, sizeof(time_t) * (size + n + 1));
+        size_t i = 0, j = 0, m = 0;
+        while (i < size || j < n) {
+            time_t next = j == n || (i < size && axis[i] <= ts[j]) ? axis[i] : ts[j];
+            if (i < size && axis[i] == next) i++;
+            while (j < n && ts[j] == next) j++;
+            merged[m++] = next;
+        }
+        time_t *swap = axis;
+        axis = merged;
+        merged = swap;
+        size = m;
+    }
+    free(merged);
+    if (size == 0) {
+        free(axis);
+        return -1;
+    }
+
+    timeline->series = series;
+    timeline->count = count;
+    timeline->time = axis;
+    timeline->size = size;
+    timeline->index = (uint32_t *)malloc(sizeof(uint32_t) * size * count);
+    size_t *cursor = (size_t *)calloc(count, sizeof(size_t));
+    for (size_t t = 0; t < size; t++) {
+        uint32_t *row = timeline->index + t * count;
+        for (size_t s = 0; s < count; s++) {
+            size_t c = cursor[s];
+            while (c < series[s].size && series[s].timestamp[c] <= axis[t])
+                c++;
+            cursor[s] = c;
+            row[s] = c ? (uint32_t)(c - 1) : LV_TIMELINE_NONE;
+        }
+    }
+    free(cursor);
+    return 0;
+}
+
+void lv_timeline_free(lv_timeline *timeline) {
+    free(timeline->time);
+    free(timeline->index);
+    memset(timeline, 0, sizeof(*timeline));
+}
+
+size_t lv_timeline_bytes(const lv_timeline *timeline) {
+    return timeline->size * (sizeof(time_t) + sizeof(uint32_t) * timeline->count);
+}
+
+void lv_timeline_close(const lv_timeline *timeline, size_t t, double *price) {
+    const uint32_t *row = timeline->index + t * timeline->count;
+    const lv_candles *series = timeline->series;
+    for (size_t s = 0; s < timeline->count; s++)
+        price[s] = row[s] == LV_TIMELINE_NONE ? 0.0 : series[s].close[row[s]];
+}
+
+// Each step is a few dense passes over the series: mark holdings to the new
+// closes, renormalise the drifted weights, and on rebalance steps measure the
+// turnover to the targets. Series without a price on either side of a step
+// contribute no return.
+int lv_portfolio_run(const lv_timeline *timeline, const lv_portfolio_config *config, double *equity, lv_portfolio_stats *stats) {
+    LV_TRACE_SPAN("lv_portfolio_run");
+    if (!timeline || !config || !config->weights || timeline->size == 0) return -1;
+
+    const size_t n = timeline->size, count = timeline->count;
+    const size_t every = config->rebalance > 1 ? config->rebalance : 1;
+    const double cost = config->commission + config->slippage;
+    double *rows = (double *)malloc(sizeof(double) * 4 * count);
+    double *prev = rows, *price = rows + count, *weight = rows + 2 * count, *held = rows + 3 * count;
+    memset(weight, 0, sizeof(double) * count);
+    lv_timeline_close(timeline, 0, prev);
+
+    double eq = 1.0, peak = 1.0, max_dd = 0.0;
+    double sum = 0.0, sum_sq = 0.0, traded = 0.0;
+    size_t trades = 0;
+    for (size_t t = 0; t < n; t++) {
+        lv_timeline_close(timeline, t, price);
+        double gross = 0.0;
+        if (t > 0) {
+            for (size_t s = 0; s < count; s++) {
+                const double q = price[s] / (prev[s] > 0.0 ? prev[s] : 1.0);
+                const double r = prev[s] > 0.0 && price[s] > 0.0 ? q - 1.0 : 0.0;
+                gross += weight[s] * r;
+                weight[s] *= 1.0 + r;
+            }
+            const double scale = 1.0 + gross > 0.0 ? 1.0 / (1.0 + gross) : 0.0;
+            for (size_t s = 0; s < count; s++)
+                weight[s] *= scale;
+        }
+
+        double turnover = 0.0;
+        if (t % every == 0) {
+            memcpy(held, weight, sizeof(double) * count);
+            config->weights(config->user, timeline, t, price, weight);
+            for (size_t s = 0; s < count; s++) {
+                const double w = price[s] > 0.0 ? weight[s] : 0.0;
+                turnover += fabs(w - held[s]);
+                weight[s] = w;
+            }
+            traded += turnover;
+            trades += turnover != 0.0;
+        }
+
+        const double ret = (1.0 + gross) * (1.0 - cost * turnover) - 1.0;
+        sum += ret;
+        sum_sq += ret * ret;
+        eq *= 1.0 + ret;
+        peak = eq > peak ? eq : peak;
+        const double dd = 1.0 - eq / peak;
+        max_dd = dd > max_dd ? dd : max_dd;
+        if (equity) equity[t] = eq;
+        double *swap = prev;
+        prev = price;
+        price = swap;
+    }
+    free(rows);
+
+    if (stats) {
+        const double years = n > 1 ? (double)(timeline->time[n - 1] - timeline->time[0]) / seconds_per_year : 0.0;
+        const backtest_totals totals = {eq, max_dd, sum, sum_sq, traded, trades};
+        backtest_stats_finish(&totals, n, years, backtest_ppy(config->periods_per_year, n, years), &stats->performance);
+        stats->timeline_bytes = lv_timeline_bytes(timeline);
+        stats->working_bytes = sizeof(double) * 4 * count;
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include "livermore.h"
+
+// Strategy evaluation over lv_candles series. In the vectorized backtester
+// positions are target exposures in units of equity (1 fully long, -1 fully
+// short, 0 flat) decided on the close of the bar they are aligned with.
+// Returns are fractions of equity and equity curves start at 1.
+
+typedef enum lv_fill {
+    LV_FILL_CLOSE,      // trade at the close of the signal bar
+    LV_FILL_NEXT_OPEN,  // trade at the open of the following bar
+} lv_fill;
+
+typedef struct lv_backtest_config {
+    lv_fill fill;
+    double commission;          // fraction of traded notional
+    double slippage;            // fraction of the fill price, always against the trade
+    double periods_per_year;    // Sharpe annualisation, 0 infers it from the timestamps
+} lv_backtest_config;
+
+typedef struct lv_backtest_stats {
+    double total_return;
+    double cagr;
+    double max_drawdown;        // largest fall from a peak, as a positive fraction of it
+    double sharpe;              // annualised, zero risk-free rate
+    double turnover;            // traded notional per year, in multiples of equity
+    size_t trades;              // bars on which the position changed; fills for lv_engine_run
+} lv_backtest_stats;
+
+// Vectorized backtest of a position series aligned with candles. Per-bar net
+// returns, the equity curve and the drawdown curve are written to returns,
+// equity and drawdown when they are not NULL (candles->size entries each).
+// Returns -1 on empty input.
+extern int lv_backtest_vector(const lv_candles *candles, const double *position, const lv_backtest_config *config,
+                              double *returns, double *equity, double *drawdown, lv_backtest_stats *stats);
+
+// Event-driven engine for path-dependent strategies. One or more series are
+// replayed bar by bar in timestamp order. After each bar closes, the
+// strategy's on_bar hook may submit, modify or cancel orders. Orders work
+// from the next bar of their series, except market orders when market_fill
+// is LV_FILL_CLOSE: those fill at the close of the bar that placed them.
+// Quantities are signed units, positive buys.
+//
+// All storage (order pool, fill log, equity curve, merge heap) is sized at
+// lv_engine_init, so a run allocates nothing. lv_engine_run resets the state
+// and may be called again, e.g. with different strategy parameters.
+
+typedef enum lv_order_type {
+    LV_ORDER_MARKET,
+    LV_ORDER_LIMIT,     // buy at or below price, sell at or above
+    LV_ORDER_STOP,      // becomes a market order once price trades through
+} lv_order_type;
+
+// Order in which a bar is assumed to visit its extremes between open and close.
+typedef enum lv_bar_path {
+    LV_PATH_NEAREST,    // the extreme nearer to the open first
+    LV_PATH_HIGH_FIRST,
+    LV_PATH_LOW_FIRST,
+} lv_bar_path;
+
+typedef struct lv_trade {
+    uint64_t order;
+    size_t series;
+    size_t bar;
+    double quantity;
+    double price;               // after slippage
+    double commission;
+} lv_trade;
+
+typedef struct lv_engine_config {
+    lv_fill market_fill;
+    lv_bar_path path;
+    double commission;          // fraction of traded notional
+    double slippage;            // fraction of price, against market and stop fills
+    double initial_cash;
+    size_t max_orders;          // working orders at any time
+    size_t max_trades;          // fill log entries kept; later fills still count
+} lv_engine_config;
+
+typedef struct lv_engine lv_engine;
+
+typedef struct lv_strategy {
+    void *user;
+    void (*on_start)(lv_engine *engine, void *user);
+    void (*on_bar)(lv_engine *engine, size_t series, size_t bar, void *user);
+    void (*on_fill)(lv_engine *engine, const lv_trade *trade, void *user);
+} lv_strategy;
+
+typedef struct lv_position {
+    double quantity;
+    double average_price;       // of the open quantity
+    double realized;            // closed PnL net of commission
+    double last;                // latest close, for marking to market
+} lv_position;
+
+typedef struct lv_order {
+    size_t series;
+    lv_order_type type;
+    double quantity;
+    double price;               // limit or stop level, unused for market orders
+    uint64_t sequence;          // submission order, breaks ties within a bar
+    uint32_t generation;        // bumped when the slot is released, stale ids stop matching
+    uint32_t prev, next;        // working list of the series, or the free list
+} lv_order;
+
+struct lv_engine {
+    const lv_candles *series;
+    size_t count;
+    lv_engine_config config;
+    lv_position *positions;
+    lv_order *orders;           // pool of max_orders
+    uint32_t *working;          // per series list head
+    uint32_t free_order;
+    uint64_t sequence;
+    uint64_t *touched;          // ids of orders triggered within the current bar
+    double *touch_at;           // distance along the bar path where each one triggered
+    uint64_t *pending;          // market orders waiting for the close (LV_FILL_CLOSE)
+    size_t pending_head;
+    size_t pending_count;
+    size_t *heap;               // series ordered by the timestamp of their next bar
+    size_t heap_size;
+    size_t *cursor;             // next bar of each series
+    lv_trade *trades;
+    size_t trade_count;         // total fills, may exceed max_trades
+    double *equity;             // one sample per distinct timestamp
+    time_t *equity_time;
+    size_t equity_count;
+    size_t equity_cap;
+    double cash;
+    double market_value;        // sum of quantity * last over all positions
+    double traded;              // notional over equity, summed per fill
+};
+
+extern int  lv_engine_init(lv_engine *engine, const lv_candles *series, size_t count, const lv_engine_config *config);
+extern void lv_engine_free(lv_engine *engine);
+// Replays every series to the end. Stats cover the equity curve, sampled once
+// per distinct timestamp after all series at that time have been processed;
+// stats->trades is trade_count, one per fill across all series.
+extern int  lv_engine_run(lv_engine *engine, const lv_strategy *strategy, lv_backtest_stats *stats);
+
+// Returns the order id, or 0 when the pool is full or the series is unknown.
+extern uint64_t lv_engine_submit(lv_engine *engine, size_t series, lv_order_type type, double quantity, double price);
+// Both return -1 if the order already filled or was cancelled.
+extern int  lv_engine_modify(lv_engine *engine, uint64_t order, double price);
+extern int  lv_engine_cancel(lv_engine *engine, uint64_t order);
+extern double lv_engine_equity(const lv_engine *engine);
+
+// Parameter sweeps. Every (parameter set, symbol) pair is one job; jobs run on
+// a pool of threads that each own a contiguous slice of the job range and
+// steal half of another slice when theirs runs dry. Jobs of one symbol are
+// adjacent, so a thread tends to stay on one series while it is hot in cache.
+// Candles and any indicator caches are only read, never copied: the job
+// callback gets the indices and finds the shared data through user.
+//
+// Results go into a columnar table, one row per pair at
+// param * symbols + symbol. Rows fill in as jobs finish; a row's metrics may
+// be read once lv_sweep_row_done reports it, while the sweep is still running.
+
+typedef struct lv_sweep_table {
+    size_t params;
+    size_t symbols;
+    double *total_return;
+    double *cagr;
+    double *max_drawdown;
+    double *sharpe;
+    double *turnover;
+    uint32_t *trades;
+    unsigned char *done;        // use lv_sweep_row_done, written by the workers
+} lv_sweep_table;
+
+extern int  lv_sweep_table_init(lv_sweep_table *table, size_t params, size_t symbols);
+extern void lv_sweep_table_free(lv_sweep_table *table);
+extern int  lv_sweep_row_done(const lv_sweep_table *table, size_t row);
+
+// A job that returns non-zero leaves NaN metrics in its row, e.g. for
+// parameter combinations that do not apply. scratch holds config.scratch
+// doubles private to the calling thread.
+typedef int (*lv_sweep_job)(void *user, size_t param, size_t symbol, double *scratch, lv_backtest_stats *stats);
+
+typedef struct lv_sweep_config {
+    lv_sweep_job job;
+    void *user;
+    size_t scratch;             // doubles per thread
+    int threads;                // 0 for one per online CPU
+} lv_sweep_config;
+
+typedef struct lv_sweep lv_sweep;
+
+// Starts the jobs in the background; NULL if the threads could not start.
+// table must stay valid until lv_sweep_wait returns.
+extern lv_sweep *lv_sweep_start(const lv_sweep_config *config, lv_sweep_table *table);
+extern size_t lv_sweep_progress(const lv_sweep *sweep);   // jobs finished
+extern void lv_sweep_cancel(lv_sweep *sweep);             // unstarted jobs are skipped
+// Joins the threads and frees the sweep. Returns -1 if it was cancelled.
+extern int  lv_sweep_wait(lv_sweep *sweep);
+
+// Walk-forward optimisation of a parameter family over one series. Fold k
+// trains on bars [k * test, k * test + train), picks the parameter set with
+// the best in-sample Sharpe and trades it on the following test bars, so the
+// test windows tile the series after the first training window.
+//
+// Nothing is recomputed per window: each parameter set's positions and net
+// returns are produced once for the whole series (in parallel), and running
+// sums of the returns are kept at every window edge. Any window's mean and
+// variance is then a difference of two sums, so adjacent, overlapping
+// training windows share all of their work. Fold selection runs in parallel
+// too; the chosen positions are stitched into one out-of-sample curve.
+
+// Writes position[first, last) for param. Positions may only depend on bars
+// up to their own; the same values must come back for any range.
+typedef int (*lv_positions_fn)(void *user, size_t param, size_t first, size_t last, double *position);
+
+typedef struct lv_walkforward_config {
+    size_t train;               // bars per training window
+    size_t test;                // bars per test window and step between folds
+    size_t params;
+    lv_positions_fn positions;
+    void *user;
+    lv_backtest_config backtest;
+    int threads;                // 0 for one per online CPU
+} lv_walkforward_config;
+
+typedef struct lv_walkforward_result {
+    size_t folds;
+    size_t first;               // first out-of-sample bar, i.e. train
+    size_t *chosen;             // per fold; params when no set was usable (flat)
+    double *train_sharpe;       // per fold, of the chosen set
+    double *test_return;        // per fold
+    double *equity;             // stitched out-of-sample curve, size - first entries
+    lv_backtest_stats stats;    // of the stitched curve
+} lv_walkforward_result;
+
+// Returns -1 if the series is not longer than one training window.
+extern int  lv_walkforward(const lv_candles *candles, const lv_walkforward_config *config, lv_walkforward_result *result);
+extern void lv_walkforward_free(lv_walkforward_result *result);
+
+// Monte Carlo bootstrap of a return series, e.g. the per-bar net returns of
+// lv_backtest_vector or the per-trade returns of lv_trade_returns. Each path
+// strings together blocks of consecutive returns drawn with replacement from
+// random start positions, wrapping at the end of the series. Every path has
+// its own counter-based random stream keyed by seed and path index, and the
+// outcomes go into fixed-bucket sketches whose integer counts merge exactly,
+// so results do not depend on the thread count and paths are never stored.
+
+typedef struct lv_bootstrap_config {
+    size_t paths;
+    size_t length;              // returns per path, rounded up to whole blocks; 0 for the input size
+    size_t block;               // consecutive returns per draw, 1 resamples them independently
+    double periods_per_year;    // of the input returns, for CAGR; 0 for 252
+    uint64_t seed;
+    const double *quantiles;    // probabilities in [0, 1]
+    size_t quantile_count;
+    int threads;                // 0 for one per online CPU
+} lv_bootstrap_config;
+
+typedef struct lv_bootstrap_result {
+    size_t paths;
+    size_t length;
+    double *total_return;       // quantile_count entries each, at config.quantiles
+    double *cagr;
+    double *max_drawdown;
+    double loss_probability;    // share of paths ending below where they started
+} lv_bootstrap_result;
+
+extern int  lv_bootstrap(size_t sz, const double *returns, const lv_bootstrap_config *config, lv_bootstrap_result *result);
+extern void lv_bootstrap_free(lv_bootstrap_result *result);
+
+// Compounds per-bar returns into one return per trade, a maximal run of bars
+// carrying the same non-zero exposure (held[i] is the position through bar i,
+// i.e. position[i - 1] with LV_FILL_CLOSE). Returns of flat bars, which are
+// only entry costs, go to the following trade; an open trade is marked at the
+// last bar. ou needs room for sz entries. Returns the number of trades.
+extern size_t lv_trade_returns(size_t sz, const double *returns, const double *held, double *ou);
+
+// Multi-asset portfolios. A timeline aligns N series onto the union of their
+// timestamps without copying them: row t of the index map holds, for every
+// series, its last bar at or before time[t] (forward fill), or
+// LV_TIMELINE_NONE before its first bar. Rows are contiguous, so a timestep
+// is one dense pass over the series.
+
+#define LV_TIMELINE_NONE UINT32_MAX
+
+typedef struct lv_timeline {
+    const lv_candles *series;
+    size_t count;
+    time_t *time;               // union axis, ascending
+    size_t size;
+    uint32_t *index;            // size x count
+} lv_timeline;
+
+// Returns -1 on empty input or series longer than the index type.
+extern int    lv_timeline_init (lv_timeline *timeline, const lv_candles *series, size_t count);
+extern void   lv_timeline_free (lv_timeline *timeline);
+extern size_t lv_timeline_bytes(const lv_timeline *timeline);
+// Forward-filled closes at row t, 0 for series that have not started.
+extern void   lv_timeline_close(const lv_timeline *timeline, size_t t, double *price);
+
+// Called on rebalance steps with the closes at t. weight holds the current
+// weights, drifted with prices since the last rebalance, and receives the
+// targets as fractions of equity; the rest is cash. Targets of series
+// without a price are dropped.
+typedef void (*lv_weights_fn)(void *user, const lv_timeline *timeline, size_t t, const double *price, double *weight);
+
+typedef struct lv_portfolio_config {
+    lv_weights_fn weights;
+    void *user;
+    size_t rebalance;           // steps between calls to weights, 0 or 1 for every step
+    double commission;          // fraction of traded notional
+    double slippage;            // fraction of the fill price, always against the trade
+    double periods_per_year;    // Sharpe annualisation, 0 infers it from the axis
+} lv_portfolio_config;
+
+typedef struct lv_portfolio_stats {
+    lv_backtest_stats performance;  // trades counts rebalances that traded
+    size_t timeline_bytes;          // axis and index map
+    size_t working_bytes;           // price and weight rows of the run
+} lv_portfolio_stats;
+
+// Steps through the axis, trading at the closes. equity (timeline->size
+// entries) is optional.
+extern int lv_portfolio_run(const lv_timeline *timeline, const lv_portfolio_config *config, double *equity, lv_portfolio_stats *stats);
+
+#endif //BACKTEST_H
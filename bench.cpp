@@ -0,0 +1,672 @@
+// imtrade microbenchmarks: response parsing, indicator kernels and chart
+// geometry. Each result is one JSON object per line on stdout so runs can be
+// diffed or loaded into a spreadsheet between releases.
+//
+//   bench [--filter SUBSTRING] [--min-time MS]
+//   bench --fetch [--requests N] [--clients C] [--bars B] [--server-threads T]
+//                 [--latency MS] [--chunk BYTES] [--body FILE]
+//
+// --fetch drives lv_candles_fetch through libcurl against a loopback
+// stand-in for the Sina getKLineData endpoint and reports throughput and
+// latency percentiles instead.
+//
+// The benchmarked code is mostly file-local, so both translation units are
+// compiled into this one. Sina responses are synthesised in the endpoint's
+// format rather than fetched.
+
+#define main imtrade_main
+#include "imtrade.cpp"
+#undef main
+#include "livermore.cpp"
+#undef min
+
+#include <chrono>
+#include <math.h>
+#include <errno.h>
+#include <map>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+struct bench_options {
+    const char* filter;
+    double      min_time_ms;
+};
+static bench_options bench_opts = { nullptr, 200.0 };
+
+static double bench_now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs fn in batches until min_time_ms has passed (at least 5 batches) and
+// reports the median and best batch. items is the work per call, for ns/item.
+template <typename F>
+static void bench_run(const char* name, size_t items, F fn) {
+    char label[128];
+    snprintf(label, sizeof(label), "%s/%zu", name, items);
+    if (bench_opts.filter && strstr(label, bench_opts.filter) == nullptr)
+        return;
+
+    double t0 = bench_now_ms();
+    fn();
+    const double once = ImMax(bench_now_ms() - t0, 1e-6);
+    const int batches = 5;
+    const uint64_t per_batch = (uint64_t)ImMax(1.0, bench_opts.min_time_ms / batches / once);
+    double ns[batches];
+    for (int b = 0; b < batches; b++) {
+        t0 = bench_now_ms();
+        for (uint64_t i = 0; i < per_batch; i++)
+            fn();
+        ns[b] = (bench_now_ms() - t0) * 1e6 / (double)per_batch;
+    }
+    std::sort(ns, ns + batches);
+    printf("{\"name\":\"%s\",\"items\":%zu,\"iters\":%llu,\"ns_per_op\":%.1f,\"ns_per_op_min\":%.1f,\"ns_per_item\":%.3f}\n",
+           name, items, (unsigned long long)(per_batch * batches), ns[batches / 2], ns[0], ns[batches / 2] / (double)items);
+    fflush(stdout);
+}
+
+// A getKLineData response body with n bars of hourly data.
+static char* bench_sina_body(size_t n) {
+    char* buf = nullptr;
+    size_t sz = 0;
+    FILE* fs = open_memstream(&buf, &sz);
+    double price = 3000.0;
+    uint32_t rng = 12345;
+    time_t t = 1577836800; // 2020-01-01
+    fputc('[', fs);
+    for (size_t i = 0; i < n; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        double open = price;
+        price *= 1.0 + ((double)(rng >> 8) / 16777216.0 - 0.5) * 0.01;
+        double hi = ImMax(open, price) * 1.002, lo = ImMin(open, price) * 0.998;
+        char day[32];
+        struct tm tm_utc;
+        time_t ts = t + (time_t)i * 3600;
+        gmtime_r(&ts, &tm_utc);
+        strftime(day, sizeof(day), "%Y-%m-%d %H:%M:%S", &tm_utc);
+        fprintf(fs, "%s{\"day\":\"%s\",\"open\":\"%.3f\",\"high\":\"%.3f\",\"low\":\"%.3f\",\"close\":\"%.3f\",\"volume\":\"%u\"}",
+                i ? "," : "", day, open, hi, lo, price, 100000u + (rng & 0xfffff));
+    }
+    fputc(']', fs);
+    fclose(fs);
+    return buf;
+}
+
+static void bench_parsing(const size_t* sizes, int size_count) {
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        char* body = bench_sina_body(n);
+        const size_t len = strlen(body);
+        bench_run("cjson_parse", n, [&] { cJSON_Delete(cJSON_ParseWithLength(body, len)); });
+
+        cJSON* json = cJSON_ParseWithLength(body, len);
+        lv_candles candles;
+        lv_candles_init(&candles, n);
+        bench_run("sina_parse_result", n, [&] { sina_parse_result(&candles, json); });
+        lv_candles_free(&candles);
+        cJSON_Delete(json);
+        free(body);
+    }
+
+    static const char* stamps[] = { "2024-03-15 10:30:00", "2023-12-29 15:00:00", "2024-07-01", "2022-02-28" };
+    volatile time_t sink = 0;
+    bench_run("parse_time_datetime", 1000, [&] {
+        for (int i = 0; i < 1000; i++) sink = parse_time(stamps[i & 1], "%Y-%m-%d %H:%M:%S");
+    });
+    bench_run("parse_time_date", 1000, [&] {
+        for (int i = 0; i < 1000; i++) sink = parse_time(stamps[2 + (i & 1)], "%Y-%m-%d");
+    });
+    (void)sink;
+}
+
+static void bench_indicators(const size_t* sizes, int size_count) {
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        double* in = (double*)malloc(sizeof(double) * n);
+        double* a = (double*)malloc(sizeof(double) * n);
+        double* b = (double*)malloc(sizeof(double) * n);
+        double* c = (double*)malloc(sizeof(double) * n);
+        double p = 100.0;
+        for (size_t i = 0; i < n; i++)
+            in[i] = p *= 1.0 + 0.01 * sin((double)i * 0.37);
+        bench_run("lv_indicator_ma", n, [&] { lv_indicator_ma(ma_window, n, in, a); });
+        bench_run("lv_indicator_ema", n, [&] { lv_indicator_ema(ma_window, n, in, a); });
+        bench_run("lv_indicator_macd", n, [&] { lv_indicator_macd(macd_fast, macd_slow, macd_signal, n, in, a, b, c); });
+        bench_run("lv_indicator_rsi", n, [&] { lv_indicator_rsi(rsi_period, n, in, a); });
+        free(in);
+        free(a);
+        free(b);
+        free(c);
+    }
+}
+
+static void bench_synth(const size_t* sizes, int size_count) {
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        lv_candles candles;
+        lv_candles_init(&candles, n);
+        bench_run("lv_candles_synth", n, [&] { lv_candles_synth(&candles, 42, "5", n); });
+        lv_candles_free(&candles);
+    }
+}
+
+// 10 years of A-share minute bars is about 590k; positions are an MA crossover.
+static void bench_backtest(const size_t* sizes, int size_count) {
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        lv_candles candles;
+        lv_candles_init(&candles, n);
+        lv_candles_synth(&candles, 7, "1", n);
+        double* fast = (double*)malloc(sizeof(double) * n);
+        double* slow = (double*)malloc(sizeof(double) * n);
+        double* position = (double*)malloc(sizeof(double) * n);
+        double* equity = (double*)malloc(sizeof(double) * n);
+        lv_indicator_ma(20, n, candles.close, fast);
+        lv_indicator_ma(120, n, candles.close, slow);
+        for (size_t i = 0; i < n; i++)
+            position[i] = i < 119 ? 0.0 : fast[i] > slow[i] ? 1.0 : -1.0;
+        lv_backtest_config config = { LV_FILL_CLOSE, 3e-4, 2e-4, 0.0 };
+        lv_backtest_stats stats;
+        bench_run("backtest_vector_close", n, [&] { lv_backtest_vector(&candles, position, &config, nullptr, nullptr, nullptr, &stats); });
+        config.fill = LV_FILL_NEXT_OPEN;
+        bench_run("backtest_vector_next_open", n, [&] { lv_backtest_vector(&candles, position, &config, nullptr, nullptr, nullptr, &stats); });
+        bench_run("backtest_vector_curves", n, [&] { lv_backtest_vector(&candles, position, &config, nullptr, equity, slow, &stats); });
+        free(fast);
+        free(slow);
+        free(position);
+        free(equity);
+        lv_candles_free(&candles);
+    }
+}
+
+// Long on a close above the 50 bar average with a 3% trailing stop that is
+// moved up every bar, so the replay exercises submit, modify and stop fills.
+struct bench_trail {
+    const lv_candles* candles;
+    const double*     ma;
+    uint64_t          stop;
+    double            level;
+};
+
+static void bench_trail_bar(lv_engine* e, size_t s, size_t i, void* user) {
+    bench_trail* t = (bench_trail*)user;
+    const double close = t->candles->close[i];
+    if (t->stop == 0 && i >= 49 && close > t->ma[i]) {
+        lv_engine_submit(e, s, LV_ORDER_MARKET, 100.0, 0.0);
+        t->level = close * 0.97;
+        t->stop = lv_engine_submit(e, s, LV_ORDER_STOP, -100.0, t->level);
+    } else if (t->stop != 0 && close * 0.97 > t->level) {
+        t->level = close * 0.97;
+        lv_engine_modify(e, t->stop, t->level);
+    }
+}
+
+static void bench_trail_fill(lv_engine*, const lv_trade* trade, void* user) {
+    bench_trail* t = (bench_trail*)user;
+    if (trade->order == t->stop)
+        t->stop = 0;
+}
+
+static void bench_engine(const size_t* sizes, int size_count) {
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        lv_candles candles;
+        lv_candles_init(&candles, n);
+        lv_candles_synth(&candles, 9, "1", n);
+        double* ma = (double*)malloc(sizeof(double) * n);
+        lv_indicator_ma(50, n, candles.close, ma);
+        lv_engine engine;
+        lv_engine_config config = { LV_FILL_NEXT_OPEN, LV_PATH_NEAREST, 3e-4, 2e-4, 1e6, 64, 4096 };
+        lv_engine_init(&engine, &candles, 1, &config);
+        bench_trail trail = { &candles, ma, 0, 0.0 };
+        lv_strategy strategy = { &trail, nullptr, bench_trail_bar, bench_trail_fill };
+        lv_backtest_stats stats;
+        bench_run("engine_trailing_stop", n, [&] {
+            trail.stop = 0;
+            lv_engine_run(&engine, &strategy, &stats);
+        });
+        lv_engine_free(&engine);
+        free(ma);
+        lv_candles_free(&candles);
+    }
+}
+
+// A ready chart over n synthetic bars, as the tabs below expect to find it.
+static void bench_synth_chart(chart* c, uint64_t seed, const char* interval, size_t n) {
+    chart_init(c, "bench", n);
+    lv_candles_synth(&c->candles, seed, interval, n);
+    c->status = chart_ready;
+}
+
+// The Sweep tab's job over synthetic charts: an 8 x 8 window grid per symbol.
+static void bench_sweep(size_t n, size_t symbols) {
+    chart* charts = (chart*)calloc(symbols, sizeof(chart));
+    for (size_t i = 0; i < symbols; i++)
+        bench_synth_chart(&charts[i], i, "1", n);
+    backtest_view view = backtest_view_defaults;
+    backtest_sweep sweep = {};
+    sweep.fast_range[0] = 5;  sweep.fast_range[1] = 40;
+    sweep.slow_range[0] = 50; sweep.slow_range[1] = 400;
+    sweep.resolution = 8;
+    bench_run("sweep_ma_grid", n * symbols * 64, [&] {
+        sweep_start(&sweep, &view, charts, symbols);
+        lv_sweep_wait(sweep.running);
+        sweep.running = nullptr;
+    });
+    sweep_release(&sweep);
+    for (size_t i = 0; i < symbols; i++)
+        chart_free(&charts[i]);
+    free(charts);
+}
+
+// The Monte Carlo tab: 100k block-bootstrap paths over a year of minute bars.
+static void bench_montecarlo(size_t n, int paths) {
+    chart c = {};
+    bench_synth_chart(&c, 1, "1", n);
+    backtest_view view = backtest_view_defaults;
+    backtest_montecarlo mc = {};
+    mc.paths  = paths;
+    mc.block  = 20;
+    mc.seed   = 1;
+    mc.status = -1;
+    bench_run("bootstrap_paths", n * (size_t)paths, [&] { montecarlo_run(&mc, &view, &c); });
+    montecarlo_free(&mc);
+    backtest_view_free(&view);
+    chart_free(&c);
+}
+
+// The Portfolio tab over a universe of daily series with staggered listings
+// and scattered missing days, so the union axis needs forward fill.
+static void bench_portfolio(size_t symbols, size_t days) {
+    chart* charts = (chart*)calloc(symbols, sizeof(chart));
+    for (size_t i = 0; i < symbols; i++) {
+        lv_candles* c = &charts[i].candles;
+        bench_synth_chart(&charts[i], i, "1d", days);
+        size_t m = 0;
+        for (size_t k = (i * 37) % (days / 4); k < days; k++) {
+            if ((k * 2654435761u + i) % 23 == 0)
+                continue;
+            c->timestamp[m] = c->timestamp[k];
+            c->open[m]      = c->open[k];
+            c->high[m]      = c->high[k];
+            c->low[m]       = c->low[k];
+            c->close[m]     = c->close[k];
+            c->volume[m]    = c->volume[k];
+            m++;
+        }
+        c->size = m;
+    }
+    backtest_view view = backtest_view_defaults;
+    backtest_portfolio p = {};
+    p.lookback  = 120;
+    p.top       = 300;
+    p.rebalance = 1;
+    p.status    = -1;
+    bench_run("portfolio_rebalance", symbols * days * 2, [&] { portfolio_run(&p, &view, charts, symbols); });
+    fprintf(stderr, "portfolio_rebalance: %zu symbols x %zu steps, index map %.1f MB, rows %.1f KB\n",
+            p.symbols, p.size, p.stats.timeline_bytes / 1048576.0, p.stats.working_bytes / 1024.0);
+    portfolio_free(&p);
+    for (size_t i = 0; i < symbols; i++)
+        chart_free(&charts[i]);
+    free(charts);
+}
+
+// The Walk-Forward tab on one synthetic chart: a 16 x 16 window grid, a year
+// of A-share minute bars per training window and about a month per fold.
+static void bench_walkforward(size_t n) {
+    chart c = {};
+    bench_synth_chart(&c, 1, "1", n);
+    backtest_view view = backtest_view_defaults;
+    backtest_sweep sweep = {};
+    sweep.fast_range[0] = 5;  sweep.fast_range[1] = 80;
+    sweep.slow_range[0] = 50; sweep.slow_range[1] = 800;
+    sweep.resolution = 16;
+    backtest_walkforward wf = {};
+    wf.train  = 59000;
+    wf.test   = 5000;
+    wf.status = -1;
+    bench_run("walkforward_ma_grid", n * 256, [&] { walkforward_run(&wf, &sweep, &view, &c); });
+    walkforward_free(&wf);
+    chart_free(&c);
+}
+
+// One offscreen ImGui frame per call; the draw data is built but not rendered.
+template <typename F>
+static void bench_frame(F draw) {
+    frame_arena_reset(&frame_scratch);
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("##bench", nullptr, ImGuiWindowFlags_NoDecoration);
+    draw();
+    ImGui::End();
+    ImGui::Render();
+}
+
+static void bench_rendering(const size_t* sizes, int size_count) {
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1920, 1080);
+    io.DeltaTime   = 1.0f / 60.0f;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    io.Fonts->Build();
+
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        char* body = bench_sina_body(n);
+        cJSON* json = cJSON_Parse(body);
+        chart c = {};
+        chart_init(&c, "bench", n);
+        c.staged_result = sina_parse_result(&c.staged, json);
+        chart_adopt(&c);
+        cJSON_Delete(json);
+        free(body);
+
+        // Settle the layout before timing. The plots outlive each size, so the
+        // x fit is re-armed to show all n bars.
+        bench_frame([&] { plot_chart("##chart", &c, false); });
+        c.refit = true;
+        bench_run("plot_candles", n, [&] {
+            bench_frame([&] {
+                chart_frame frame = {};
+                if (ImPlot::BeginPlot("##Price", ImVec2(-1, -1))) {
+                    ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
+                    plot_candles("##chart", &c, &frame, false);
+                    ImPlot::EndPlot();
+                }
+            });
+        });
+        bench_run("plot_chart", n, [&] { bench_frame([&] { plot_chart("##chart", &c, false); }); });
+        chart_free(&c);
+    }
+
+    // Replay with n bars of history already played: one bar appended and the
+    // followed chart drawn per call. Flat ns_per_op across n is the point.
+    for (int k = 0; k < size_count; k++) {
+        const size_t n = sizes[k];
+        const size_t tape = n + 65536;
+        chart c = {};
+        bench_synth_chart(&c, 1, "1", tape);
+        chart_update(&c);
+        chart_replay r = {};
+        r.start  = (int)n;
+        r.follow = true;
+        r.window = 200;
+        replay_load(&r, &c);
+        r.view.follow = r.window;
+        bench_frame([&] { plot_chart("##replay", &r.view, false); });
+        bench_run("replay_frame", n, [&] {
+            if (r.next >= r.tape.size)
+                replay_load(&r, &c);
+            replay_step(&r, 1);
+            bench_frame([&] { plot_chart("##replay", &r.view, false); });
+        });
+        replay_free(&r);
+        chart_free(&c);
+    }
+
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+}
+
+// Loopback stand-in for getKLineData. Each server thread blocks in accept()
+// on the shared socket and answers one request per connection, like the
+// one-shot curl handles lv_candles_fetch uses. Bodies are synthesised once
+// per datalen, or read from a recorded file served for every request.
+struct kline_server {
+    int                      fd;
+    int                      port;
+    unsigned                 latency_ms;
+    size_t                   chunk;      // Transfer-Encoding: chunked pieces, 0 for Content-Length
+    std::string              fixed_body;
+    bool                     fixed;
+    std::mutex               lock;       // guards bodies
+    std::map<size_t, std::string> bodies; // node based: handed-out bodies stay put as others are added
+    std::vector<std::thread> threads;
+};
+
+static bool send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static const std::string* kline_server_body(kline_server* s, size_t datalen) {
+    if (s->fixed)
+        return &s->fixed_body;
+    std::lock_guard<std::mutex> lk(s->lock);
+    auto it = s->bodies.find(datalen);
+    if (it != s->bodies.end())
+        return &it->second;
+    char* body = bench_sina_body(datalen);
+    it = s->bodies.emplace(datalen, std::string(body)).first;
+    free(body);
+    return &it->second;
+}
+
+static void kline_server_respond(kline_server* s, int fd) {
+    char req[8192];
+    size_t len = 0;
+    while (len < sizeof(req) - 1) {
+        ssize_t n = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (n <= 0)
+            return;
+        len += (size_t)n;
+        req[len] = 0;
+        if (strstr(req, "\r\n\r\n"))
+            break;
+    }
+    char head[256];
+    const char* datalen = strstr(req, "datalen=");
+    if (strncmp(req, "GET ", 4) != 0 || !strstr(req, "CN_MarketData.getKLineData") || datalen == nullptr) {
+        int n = snprintf(head, sizeof(head), "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        send_all(fd, head, (size_t)n);
+        return;
+    }
+    const std::string* body = kline_server_body(s, (size_t)strtoull(datalen + 8, nullptr, 10));
+    if (s->latency_ms)
+        std::this_thread::sleep_for(std::chrono::milliseconds(s->latency_ms));
+    if (s->chunk == 0) {
+        int n = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", body->size());
+        if (send_all(fd, head, (size_t)n))
+            send_all(fd, body->data(), body->size());
+        return;
+    }
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n");
+    bool ok = send_all(fd, head, (size_t)n);
+    for (size_t off = 0; ok && off < body->size(); off += s->chunk) {
+        size_t part = ImMin(s->chunk, body->size() - off);
+        n = snprintf(head, sizeof(head), "%zx\r\n", part);
+        ok = send_all(fd, head, (size_t)n) && send_all(fd, body->data() + off, part) && send_all(fd, "\r\n", 2);
+    }
+    if (ok)
+        send_all(fd, "0\r\n\r\n", 5);
+}
+
+static void kline_server_run(kline_server* s) {
+    for (;;) {
+        int fd = accept(s->fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return; // listening socket shut down
+        }
+        kline_server_respond(s, fd);
+        close(fd);
+    }
+}
+
+// Binds an ephemeral loopback port; returns -1 on failure.
+static int kline_server_start(kline_server* s, int threads) {
+    s->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->fd < 0)
+        return -1;
+    int one = 1;
+    setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (bind(s->fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(s->fd, 1024) != 0 ||
+        getsockname(s->fd, (sockaddr*)&addr, &addr_len) != 0) {
+        close(s->fd);
+        return -1;
+    }
+    s->port = ntohs(addr.sin_port);
+    for (int i = 0; i < threads; i++)
+        s->threads.emplace_back(kline_server_run, s);
+    return 0;
+}
+
+static void kline_server_stop(kline_server* s) {
+    shutdown(s->fd, SHUT_RDWR);
+    for (std::thread& t : s->threads)
+        t.join();
+    close(s->fd);
+}
+
+struct fetch_bench_options {
+    int         requests;
+    int         clients;
+    size_t      bars;
+    int         server_threads;
+    unsigned    latency_ms;
+    size_t      chunk;
+    const char* body_path;
+};
+
+static double percentile(std::vector<double>& sorted, double p) {
+    if (sorted.empty())
+        return 0.0;
+    size_t i = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+    return sorted[ImMin(i, sorted.size() - 1)];
+}
+
+static int bench_fetch(const fetch_bench_options* o) {
+    kline_server server;
+    server.latency_ms = o->latency_ms;
+    server.chunk = o->chunk;
+    server.fixed = o->body_path != nullptr;
+    if (server.fixed) {
+        FILE* f = fopen(o->body_path, "rb");
+        if (f == nullptr) {
+            fprintf(stderr, "bench: cannot read %s\n", o->body_path);
+            return 1;
+        }
+        char buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            server.fixed_body.append(buf, n);
+        fclose(f);
+    }
+    if (kline_server_start(&server, o->server_threads) != 0) {
+        perror("bench: loopback server");
+        return 1;
+    }
+    static char host[64];
+    snprintf(host, sizeof(host), "http://127.0.0.1:%d", server.port);
+    lv_sina_set_host(host);
+
+    // Warm the body cache so the first clients do not pay for synthesis.
+    lv_candles warm;
+    lv_candles_init(&warm, o->bars);
+    lv_candles_fetch(&warm, "sina", "warmup", "1h");
+    lv_candles_free(&warm);
+
+    std::vector<double> latency_ms((size_t)o->requests);
+    std::atomic<int> next(0), errors(0);
+    double t0 = bench_now_ms();
+    std::vector<std::thread> clients;
+    for (int c = 0; c < o->clients; c++) {
+        clients.emplace_back([&] {
+            lv_candles candles;
+            lv_candles_init(&candles, o->bars);
+            char symbol[32];
+            for (int i; (i = next.fetch_add(1)) < o->requests; ) {
+                snprintf(symbol, sizeof(symbol), "sh%06d", i % 1000);
+                double start = bench_now_ms();
+                if (lv_candles_fetch(&candles, "sina", symbol, "1h") != 0 || candles.size == 0)
+                    errors.fetch_add(1);
+                latency_ms[(size_t)i] = bench_now_ms() - start;
+            }
+            lv_candles_free(&candles);
+        });
+    }
+    for (std::thread& t : clients)
+        t.join();
+    double secs = (bench_now_ms() - t0) / 1000.0;
+    kline_server_stop(&server);
+
+    std::sort(latency_ms.begin(), latency_ms.end());
+    printf("{\"name\":\"fetch\",\"requests\":%d,\"clients\":%d,\"bars\":%zu,\"server_threads\":%d,\"latency_ms\":%u,\"chunk\":%zu,"
+           "\"errors\":%d,\"fetches_per_s\":%.1f,\"p50_ms\":%.3f,\"p90_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f}\n",
+           o->requests, o->clients, o->bars, o->server_threads, o->latency_ms, o->chunk, errors.load(), o->requests / secs,
+           percentile(latency_ms, 0.50), percentile(latency_ms, 0.90), percentile(latency_ms, 0.99), latency_ms.empty() ? 0.0 : latency_ms.back());
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    bool fetch = false;
+    fetch_bench_options fo = { 2000, 8, 1000, 4, 0, 0, nullptr };
+    for (int i = 1; i < argc; ) {
+        if (strcmp(argv[i], "--fetch") == 0) {
+            fetch = true;
+            i++;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && strcmp(argv[i], "--filter") == 0)              bench_opts.filter = value;
+        else if (value && strcmp(argv[i], "--min-time") == 0)       bench_opts.min_time_ms = atof(value);
+        else if (value && strcmp(argv[i], "--requests") == 0)       fo.requests = atoi(value);
+        else if (value && strcmp(argv[i], "--clients") == 0)        fo.clients = atoi(value);
+        else if (value && strcmp(argv[i], "--bars") == 0)           fo.bars = (size_t)strtoull(value, nullptr, 10);
+        else if (value && strcmp(argv[i], "--server-threads") == 0) fo.server_threads = atoi(value);
+        else if (value && strcmp(argv[i], "--latency") == 0)        fo.latency_ms = (unsigned)atoi(value);
+        else if (value && strcmp(argv[i], "--chunk") == 0)          fo.chunk = (size_t)strtoull(value, nullptr, 10);
+        else if (value && strcmp(argv[i], "--body") == 0)           fo.body_path = value;
+        else {
+            fprintf(stderr, "usage: %s [--filter SUBSTRING] [--min-time MS]\n"
+                            "       %s --fetch [--requests N] [--clients C] [--bars B] [--server-threads T] [--latency MS] [--chunk BYTES] [--body FILE]\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+        i += 2;
+    }
+    if (fetch) {
+        if (fo.requests <= 0 || fo.clients <= 0 || fo.bars == 0 || fo.server_threads <= 0) {
+            fprintf(stderr, "bench: --requests, --clients, --bars and --server-threads must be positive\n");
+            return 1;
+        }
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        int result = bench_fetch(&fo);
+        curl_global_cleanup();
+        return result;
+    }
+
+    static const size_t response_sizes[]  = { 1000, 100000, 1000000 };
+    static const size_t indicator_sizes[] = { 1000, 100000, 1000000, 10000000 };
+    static const size_t chart_sizes[]     = { 1000, 100000, 1000000 };
+    static const size_t backtest_sizes[]  = { 1000, 100000, 590000 };
+    static const size_t engine_sizes[]    = { 100000, 1000000 };
+    bench_parsing(response_sizes, IM_ARRAYSIZE(response_sizes));
+    bench_indicators(indicator_sizes, IM_ARRAYSIZE(indicator_sizes));
+    bench_synth(indicator_sizes, IM_ARRAYSIZE(indicator_sizes));
+    bench_backtest(backtest_sizes, IM_ARRAYSIZE(backtest_sizes));
+    bench_engine(engine_sizes, IM_ARRAYSIZE(engine_sizes));
+    bench_sweep(100000, 8);
+    bench_montecarlo(59000, 100000);
+    bench_portfolio(3000, 2520);
+    bench_walkforward(590000);
+    bench_rendering(chart_sizes, IM_ARRAYSIZE(chart_sizes));
+    frame_arena_reset(&frame_scratch);
+    free(frame_scratch.data);
+    return 0;
+}
@@ -117,6 +117,11 @@
 // Another way to allow large meshes while keeping 16-bit indices is to handle ImDrawCmd::VtxOffset in your renderer.
 // Read about ImGuiBackendFlags_RendererHasVtxOffset for details.
 //#define ImDrawIdx unsigned int
+// imtrade: the Makefile defines IMTRADE_DRAW_IDX32 by default so that dense candle and line plots are not split into a
+// new draw command every 64K vertices. Build with `make DRAW_IDX32=0` to get the 16-bit + VtxOffset path back.
+#if defined(IMTRADE_DRAW_IDX32) && !defined(ImDrawIdx)
+#define ImDrawIdx unsigned int
+#endif
 
 //---- Override ImDrawCallback signature (will need to modify renderer backends accordingly)
 //struct ImDrawList;
@@ -24,6 +24,7 @@
 // - Introduction, links and more at the top of imgui.cpp
 
 // CHANGELOG
+//  2026-10-19: Merge adjacent draw commands sharing texture, clip rect and vertex offset, skip redundant SDL_RenderSetClipRect() calls and only pass the vertices a command references to SDL_RenderGeometryRaw() (rebasing indices of small batches when ImDrawIdx is 32-bit).
 //  2025-06-11: Added support for ImGuiBackendFlags_RendererHasTextures, for dynamic font atlas. Removed ImGui_ImplSDLRenderer2_CreateFontsTexture() and ImGui_ImplSDLRenderer2_DestroyFontsTexture().
 //  2025-01-18: Use endian-dependent RGBA32 texture format, to match SDL_Color.
 //  2024-10-09: Expose selected render state in ImGui_ImplSDLRenderer2_RenderState, which you can access in 'void* platform_io.Renderer_RenderState' during draw callbacks.
@@ -58,6 +59,7 @@
 struct ImGui_ImplSDLRenderer2_Data
 {
     SDL_Renderer*   Renderer;       // Main viewport's renderer
+    ImVector<ImDrawIdx> IdxScratch; // Rebased indices for batches that only reference the end of a large vertex buffer
 
     ImGui_ImplSDLRenderer2_Data()   { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -120,6 +122,8 @@ void ImGui_ImplSDLRenderer2_NewFrame()
 
 void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer* renderer)
 {
+    ImGui_ImplSDLRenderer2_Data* bd = ImGui_ImplSDLRenderer2_GetBackendData();
+
     // If there's a scale factor set by the user, use that instead
     // If the user has specified a scale factor to SDL_Renderer already via SDL_RenderSetScale(), SDL will scale whatever we pass
     // to SDL_RenderGeometryRaw() by that scale factor. In that case we don't want to be also scaling it ourselves here.
@@ -169,6 +173,13 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
     ImVec2 clip_scale = render_scale;
 
     // Render command lists
+    // - Adjacent commands with the same texture, clip rect and vertex offset whose indices follow each other
+    //   are submitted as a single SDL_RenderGeometryRaw() call.
+    // - The clip rect is only re-applied when it differs from the one currently set.
+    // - SDL validates every vertex it is handed, so we pass only up to the highest index the batch references
+    //   instead of the rest of the vertex buffer.
+    SDL_Rect current_clip = {};
+    bool current_clip_valid = false;
     for (const ImDrawList* draw_list : draw_data->CmdLists)
     {
         const ImDrawVert* vtx_buffer = draw_list->VtxBuffer.Data;
@@ -185,9 +196,25 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
                     ImGui_ImplSDLRenderer2_SetupRenderState(renderer);
                 else
                     pcmd->UserCallback(draw_list, pcmd);
+                current_clip_valid = false;
             }
             else
             {
+                // Coalesce with the following commands
+                SDL_Texture* tex = (SDL_Texture*)pcmd->GetTexID();
+                unsigned int elem_count = pcmd->ElemCount;
+                while (cmd_i + 1 < draw_list->CmdBuffer.Size)
+                {
+                    const ImDrawCmd* next = &draw_list->CmdBuffer[cmd_i + 1];
+                    if (next->UserCallback != nullptr || (SDL_Texture*)next->GetTexID() != tex || next->VtxOffset != pcmd->VtxOffset ||
+                        next->IdxOffset != pcmd->IdxOffset + elem_count || memcmp(&next->ClipRect, &pcmd->ClipRect, sizeof(pcmd->ClipRect)) != 0)
+                        break;
+                    elem_count += next->ElemCount;
+                    cmd_i++;
+                }
+                if (elem_count == 0)
+                    continue;
+
                 // Project scissor/clipping rectangles into framebuffer space
                 ImVec2 clip_min((pcmd->ClipRect.x - clip_off.x) * clip_scale.x, (pcmd->ClipRect.y - clip_off.y) * clip_scale.y);
                 ImVec2 clip_max((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, (pcmd->ClipRect.w - clip_off.y) * clip_scale.y);
@@ -199,24 +226,51 @@ void ImGui_ImplSDLRenderer2_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
                     continue;
 
                 SDL_Rect r = { (int)(clip_min.x), (int)(clip_min.y), (int)(clip_max.x - clip_min.x), (int)(clip_max.y - clip_min.y) };
-                SDL_RenderSetClipRect(renderer, &r);
-
-                const float* xy = (const float*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, pos));
-                const float* uv = (const float*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, uv));
+                if (!current_clip_valid || memcmp(&r, &current_clip, sizeof(r)) != 0)
+                {
+                    SDL_RenderSetClipRect(renderer, &r);
+                    current_clip = r;
+                    current_clip_valid = true;
+                }
+
+                // Vertices referenced by this batch. With 32-bit indices everything shares VtxOffset 0, so a small batch
+                // drawn after a large mesh is rebased onto its own range when that skips more vertices than it copies.
+                const ImDrawIdx* indices = idx_buffer + pcmd->IdxOffset;
+                unsigned int min_idx = ~0u, max_idx = 0;
+                for (unsigned int i = 0; i < elem_count; i++)
+                {
+                    min_idx = indices[i] < min_idx ? indices[i] : min_idx;
+                    max_idx = indices[i] > max_idx ? indices[i] : max_idx;
+                }
+                unsigned int vtx_first = pcmd->VtxOffset;
+                if (min_idx > elem_count)
+                {
+                    bd->IdxScratch.resize((int)elem_count);
+                    for (unsigned int i = 0; i < elem_count; i++)
+                        bd->IdxScratch.Data[i] = (ImDrawIdx)(indices[i] - min_idx);
+                    indices = bd->IdxScratch.Data;
+                    vtx_first += min_idx;
+                    max_idx -= min_idx;
+                }
+                int vtx_count = (int)max_idx + 1;
+                if (vtx_count > draw_list->VtxBuffer.Size - (int)vtx_first)
+                    vtx_count = draw_list->VtxBuffer.Size - (int)vtx_first;
+
+                const float* xy = (const float*)(const void*)((const char*)(vtx_buffer + vtx_first) + offsetof(ImDrawVert, pos));
+                const float* uv = (const float*)(const void*)((const char*)(vtx_buffer + vtx_first) + offsetof(ImDrawVert, uv));
 #if SDL_VERSION_ATLEAST(2,0,19)
-                const SDL_Color* color = (const SDL_Color*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, col)); // SDL 2.0.19+
+                const SDL_Color* color = (const SDL_Color*)(const void*)((const char*)(vtx_buffer + vtx_first) + offsetof(ImDrawVert, col)); // SDL 2.0.19+
 #else
-                const int* color = (const int*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, col)); // SDL 2.0.17 and 2.0.18
+                const int* color = (const int*)(const void*)((const char*)(vtx_buffer + vtx_first) + offsetof(ImDrawVert, col)); // SDL 2.0.17 and 2.0.18
 #endif
 
                 // Bind texture, Draw
-                SDL_Texture* tex = (SDL_Texture*)pcmd->GetTexID();
                 SDL_RenderGeometryRaw(renderer, tex,
                     xy, (int)sizeof(ImDrawVert),
                     color, (int)sizeof(ImDrawVert),
                     uv, (int)sizeof(ImDrawVert),
-                    draw_list->VtxBuffer.Size - pcmd->VtxOffset,
-                    idx_buffer + pcmd->IdxOffset, pcmd->ElemCount, sizeof(ImDrawIdx));
+                    vtx_count,
+                    indices, (int)elem_count, sizeof(ImDrawIdx));
             }
         }
     }
@@ -134,6 +134,14 @@ You can read releases logs https://github.com/epezent/implot/releases for more d
 
 #include <stdlib.h>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#define IMPLOT_TRANSFORM_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMPLOT_TRANSFORM_SSE2
+#endif
+
 // Support for pre-1.82 versions. Users on 1.82+ can use 0 (default) flags to mean "all corners" but in order to support older versions we are more explicit.
 #if (IMGUI_VERSION_NUM < 18102) && !defined(ImDrawFlags_RoundCornersAll)
 #define ImDrawFlags_RoundCornersAll ImDrawCornerFlags_All
@@ -3705,6 +3713,68 @@ ImVec2 PlotToPixels(const ImPlotPoint& plt, ImAxis x_idx, ImAxis y_idx) {
     return PlotToPixels(plt.x, plt.y, x_idx, y_idx);
 }
 
+// pix[i] = pix_min + m * (plt[i] - plt_min), evaluated in double like ImPlotAxis::PlotToPixels.
+static void TransformLinear(const double* plt, float* pix, int count, double pix_min, double m, double plt_min) {
+    int i = 0;
+#if defined(IMPLOT_TRANSFORM_AVX)
+    const __m256d v_min = _mm256_set1_pd(plt_min);
+    const __m256d v_m   = _mm256_set1_pd(m);
+    const __m256d v_pix = _mm256_set1_pd(pix_min);
+    for (; i + 4 <= count; i += 4) {
+        __m256d p = _mm256_loadu_pd(plt + i);
+        p = _mm256_add_pd(v_pix, _mm256_mul_pd(v_m, _mm256_sub_pd(p, v_min)));
+        _mm_storeu_ps(pix + i, _mm256_cvtpd_ps(p));
+    }
+#elif defined(IMPLOT_TRANSFORM_SSE2)
+    const __m128d v_min = _mm_set1_pd(plt_min);
+    const __m128d v_m   = _mm_set1_pd(m);
+    const __m128d v_pix = _mm_set1_pd(pix_min);
+    for (; i + 4 <= count; i += 4) {
+        __m128d lo = _mm_loadu_pd(plt + i);
+        __m128d hi = _mm_loadu_pd(plt + i + 2);
+        lo = _mm_add_pd(v_pix, _mm_mul_pd(v_m, _mm_sub_pd(lo, v_min)));
+        hi = _mm_add_pd(v_pix, _mm_mul_pd(v_m, _mm_sub_pd(hi, v_min)));
+        _mm_storeu_ps(pix + i, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+    }
+#endif
+    for (; i < count; ++i)
+        pix[i] = (float)(pix_min + m * (plt[i] - plt_min));
+}
+
+void PlotToPixels(const ImPlotAxis& axis, const double* plt, float* pix, int count, int pix_stride) {
+    if (axis.TransformForward != nullptr) {
+        for (int i = 0; i < count; ++i)
+            pix[i * pix_stride] = axis.PlotToPixels(plt[i]);
+        return;
+    }
+    if (pix_stride == 1) {
+        TransformLinear(plt, pix, count, axis.PixelMin, axis.ScaleToPixel, axis.Range.Min);
+        return;
+    }
+    float block[256];
+    for (int i = 0; i < count; i += 256) {
+        const int n = ImMin(256, count - i);
+        TransformLinear(plt + i, block, n, axis.PixelMin, axis.ScaleToPixel, axis.Range.Min);
+        for (int k = 0; k < n; ++k)
+            pix[(i + k) * pix_stride] = block[k];
+    }
+}
+
+void PlotToPixels(const double* xs, const double* ys, ImVec2* pix, int count, ImAxis x_idx, ImAxis y_idx) {
+    ImPlotContext& gp = *GImPlot;
+    IM_ASSERT_USER_ERROR(gp.CurrentPlot != nullptr, "PlotToPixels() needs to be called between BeginPlot() and EndPlot()!");
+    IM_ASSERT_USER_ERROR(x_idx == IMPLOT_AUTO || (x_idx >= ImAxis_X1 && x_idx < ImAxis_Y1),    "X-Axis index out of bounds!");
+    IM_ASSERT_USER_ERROR(y_idx == IMPLOT_AUTO || (y_idx >= ImAxis_Y1 && y_idx < ImAxis_COUNT), "Y-Axis index out of bounds!");
+    SetupLock();
+    ImPlotPlot& plot = *gp.CurrentPlot;
+    ImPlotAxis& x_axis = x_idx == IMPLOT_AUTO ? plot.Axes[plot.CurrentX] : plot.Axes[x_idx];
+    ImPlotAxis& y_axis = y_idx == IMPLOT_AUTO ? plot.Axes[plot.CurrentY] : plot.Axes[y_idx];
+    if (count <= 0)
+        return;
+    PlotToPixels(x_axis, xs, &pix[0].x, count, 2);
+    PlotToPixels(y_axis, ys, &pix[0].y, count, 2);
+}
+
 ImVec2 GetPlotPos() {
     ImPlotContext& gp = *GImPlot;
     IM_ASSERT_USER_ERROR(gp.CurrentPlot != nullptr, "GetPlotPos() needs to be called between BeginPlot() and EndPlot()!");
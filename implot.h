@@ -234,6 +234,7 @@ enum ImPlotLineFlags_ {
     ImPlotLineFlags_SkipNaN     = 1 << 12, // NaNs values will be skipped instead of rendered as missing data
     ImPlotLineFlags_NoClip      = 1 << 13, // markers (if displayed) on the edge of a plot will not be clipped
     ImPlotLineFlags_Shaded      = 1 << 14, // a filled region between the line and horizontal origin will be rendered; use PlotShaded for more advanced cases
+    ImPlotLineFlags_Downsample  = 1 << 15, // x values are sorted ascending; only the visible range is processed and, when it holds more points than pixels, each pixel column is reduced to its first/min/max/last points (not used with Segments, Loop or SkipNaN)
 };
 
 // Flags for PlotScatter
@@ -975,6 +976,8 @@ IMPLOT_API ImPlotPoint PixelsToPlot(float x, float y, ImAxis x_axis = IMPLOT_AUT
 // Convert a position in the current plot's coordinate system to pixels. Passing IMPLOT_AUTO uses the current axes.
 IMPLOT_API ImVec2 PlotToPixels(const ImPlotPoint& plt, ImAxis x_axis = IMPLOT_AUTO, ImAxis y_axis = IMPLOT_AUTO);
 IMPLOT_API ImVec2 PlotToPixels(double x, double y, ImAxis x_axis = IMPLOT_AUTO, ImAxis y_axis = IMPLOT_AUTO);
+// Batch version of the above for count points. Linear axes are transformed with SSE2/AVX when available.
+IMPLOT_API void PlotToPixels(const double* xs, const double* ys, ImVec2* pix, int count, ImAxis x_axis = IMPLOT_AUTO, ImAxis y_axis = IMPLOT_AUTO);
 
 // Get the current Plot position (top-left) in pixels.
 IMPLOT_API ImVec2 GetPlotPos();
@@ -1128,6 +1131,10 @@ IMPLOT_API void SetNextFillStyle(const ImVec4& col = IMPLOT_AUTO_COL, float alph
 IMPLOT_API void SetNextMarkerStyle(ImPlotMarker marker = IMPLOT_AUTO, float size = IMPLOT_AUTO, const ImVec4& fill = IMPLOT_AUTO_COL, float weight = IMPLOT_AUTO, const ImVec4& outline = IMPLOT_AUTO_COL);
 // Set the error bar style for the next item only.
 IMPLOT_API void SetNextErrorBarStyle(const ImVec4& col = IMPLOT_AUTO_COL, float size = IMPLOT_AUTO, float weight = IMPLOT_AUTO);
+// Identify the data of the next ImPlotLineFlags_Downsample line. While the version stays the same the item's
+// min/max pyramid is kept and only appended points and a changed last point are folded in, so any other change
+// needs a new version. Without a version the pyramid is rebuilt on every frame.
+IMPLOT_API void SetNextLineLOD(ImU64 version);
 
 // Gets the last item primary color (i.e. its legend icon color)
 IMPLOT_API ImVec4 GetLastItemColor();
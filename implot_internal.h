@@ -936,16 +936,45 @@ struct ImPlotAlignmentData {
     void Reset() { PadA = PadB = PadAMax = PadBMax = 0; }
 };
 
+// Min/max of a point range along with where the extremes occur
+struct ImPlotLineLODNode
+{
+    double Min, Max;
+    int    IdxMin, IdxMax;
+};
+
+// Min/max pyramid over the y values of a line plotted with ImPlotLineFlags_Downsample.
+// Level 0 summarizes blocks of IMPLOT_LOD_BLOCK points and each further level
+// halves the node count, so any index range is reduced in O(log n). The pyramid
+// is rebuilt lazily from the item's getter: under an unchanged SetNextLineLOD
+// version appended points and a changed last point are folded in incrementally,
+// anything else triggers a full rebuild.
+#define IMPLOT_LOD_BLOCK      32
+#define IMPLOT_LOD_MAX_LEVELS 32
+struct ImPlotLineLOD
+{
+    ImVector<ImPlotLineLODNode> Levels[IMPLOT_LOD_MAX_LEVELS];
+    int    LevelCount;
+    int    Count;                         // number of points summarized
+    bool   HasVersion;
+    ImU64  Version;                       // SetNextLineLOD version the points came from
+    int    Frame;                         // frame of the last unversioned rebuild
+    double LastX, LastY;                  // point Count-1, allowed to change between frames
+
+    ImPlotLineLOD() { LevelCount = 0; Count = 0; HasVersion = false; Version = 0; Frame = -1; LastX = LastY = 0; }
+};
+
 // State information for Plot items
 struct ImPlotItem
 {
-    ImGuiID      ID;
-    ImU32        Color;
-    ImRect       LegendHoverRect;
-    int          NameOffset;
-    bool         Show;
-    bool         LegendHovered;
-    bool         SeenThisFrame;
+    ImGuiID        ID;
+    ImU32          Color;
+    ImRect         LegendHoverRect;
+    int            NameOffset;
+    bool           Show;
+    bool           LegendHovered;
+    bool           SeenThisFrame;
+    ImPlotLineLOD* LOD;          // allocated on first use by ImPlotLineFlags_Downsample
 
     ImPlotItem() {
         ID            = 0;
@@ -954,9 +983,10 @@ struct ImPlotItem
         Show          = true;
         SeenThisFrame = false;
         LegendHovered = false;
+        LOD           = nullptr;
     }
 
-    ~ImPlotItem() { ID = 0; }
+    ~ImPlotItem() { ID = 0; if (LOD) IM_DELETE(LOD); }
 };
 
 // Holds Legend state
@@ -1190,6 +1220,8 @@ struct ImPlotNextItemData {
     bool            HasHidden;
     bool            Hidden;
     ImPlotCond      HiddenCond;
+    bool            HasLODVersion;
+    ImU64           LODVersion;
     ImPlotNextItemData() { Reset(); }
     void Reset() {
         for (int i = 0; i < 5; ++i)
@@ -1197,6 +1229,7 @@ struct ImPlotNextItemData {
         LineWeight    = MarkerSize = MarkerWeight = FillAlpha = ErrorBarSize = ErrorBarWeight = DigitalBitHeight = DigitalBitGap = IMPLOT_AUTO;
         Marker        = IMPLOT_AUTO;
         HasHidden     = Hidden = false;
+        HasLODVersion = false;
     }
 };
 
@@ -1231,6 +1264,7 @@ struct ImPlotContext {
     // Temp data for general use
     ImVector<double>   TempDouble1, TempDouble2;
     ImVector<int>      TempInt1;
+    ImVector<ImVec2>   TempVec2;
 
     // Misc
     int                DigitalPlotItemCnt;
@@ -1405,6 +1439,10 @@ static inline void FitPoint(const ImPlotPoint& p) {
 static inline bool RangesOverlap(const ImPlotRange& r1, const ImPlotRange& r2)
 { return r1.Min <= r2.Max && r2.Min <= r1.Max; }
 
+// Transforms count values along axis to pixels, writing every pix_stride-th float of pix. Same results as
+// ImPlotAxis::PlotToPixels; linear axes are vectorized, other scales go point by point.
+IMPLOT_API void PlotToPixels(const ImPlotAxis& axis, const double* plt, float* pix, int count, int pix_stride = 1);
+
 // Shows an axis's context menu.
 IMPLOT_API void ShowAxisContextMenu(ImPlotAxis& axis, ImPlotAxis* equal_axis, bool time_allowed = false);
 
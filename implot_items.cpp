@@ -350,6 +350,12 @@ void SetNextErrorBarStyle(const ImVec4& col, float size, float weight) {
     gp.NextItemData.ErrorBarWeight             = weight;
 }
 
+void SetNextLineLOD(ImU64 version) {
+    ImPlotContext& gp = *GImPlot;
+    gp.NextItemData.HasLODVersion = true;
+    gp.NextItemData.LODVersion    = version;
+}
+
 ImVec4 GetLastItemColor() {
     ImPlotContext& gp = *GImPlot;
     if (gp.PreviousItem)
@@ -621,6 +627,17 @@ struct GetterLoop {
     const int Count;
 };
 
+template <typename _Getter>
+struct GetterSlice {
+    GetterSlice(const _Getter& getter, int offset, int count) : Getter(getter), Offset(offset), Count(count) { }
+    template <typename I> IMPLOT_INLINE ImPlotPoint operator()(I idx) const {
+        return Getter(idx + Offset);
+    }
+    const _Getter& Getter;
+    const int Offset;
+    const int Count;
+};
+
 template <typename T>
 struct GetterError {
     GetterError(const T* xs, const T* ys, const T* neg, const T* pos, int count, int offset, int stride) :
@@ -894,6 +911,32 @@ struct RendererLineStrip : RendererBase {
     mutable ImVec2 UV1;
 };
 
+/// Line strip through points already transformed to pixels, e.g. by the batch PlotToPixels.
+struct RendererLineStripPixels : RendererBase {
+    RendererLineStripPixels(const ImVec2* pix, int count, ImU32 col, float weight) :
+        RendererBase(count - 1, 6, 4),
+        Pix(pix),
+        Col(col),
+        HalfWeight(ImMax(1.0f,weight)*0.5f)
+    { }
+    void Init(ImDrawList& draw_list) const {
+        GetLineRenderProps(draw_list, HalfWeight, UV0, UV1);
+    }
+    IMPLOT_INLINE bool Render(ImDrawList& draw_list, const ImRect& cull_rect, int prim) const {
+        const ImVec2& P1 = Pix[prim];
+        const ImVec2& P2 = Pix[prim + 1];
+        if (!cull_rect.Overlaps(ImRect(ImMin(P1, P2), ImMax(P1, P2))))
+            return false;
+        PrimLine(draw_list,P1,P2,HalfWeight,Col,UV0,UV1);
+        return true;
+    }
+    const ImVec2* Pix;
+    const ImU32 Col;
+    mutable float HalfWeight;
+    mutable ImVec2 UV0;
+    mutable ImVec2 UV1;
+};
+
 template <class _Getter>
 struct RendererLineStripSkip : RendererBase {
     RendererLineStripSkip(const _Getter& getter, ImU32 col, float weight) :
@@ -1565,19 +1608,294 @@ void RenderMarkers(const _Getter& getter, ImPlotMarker marker, float size, bool
     }
 }
 
+//-----------------------------------------------------------------------------
+// [SECTION] Downsampling
+//-----------------------------------------------------------------------------
+
+// First index in [lo,hi) whose x is >= x. Requires ascending x.
+template <typename _Getter>
+static inline int LowerBoundX(const _Getter& getter, int lo, int hi, double x) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (getter(mid).x < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// First index in [lo,hi) whose x is > x. Requires ascending x.
+template <typename _Getter>
+static inline int UpperBoundX(const _Getter& getter, int lo, int hi, double x) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (getter(mid).x <= x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static inline void CombineLOD(ImPlotLineLODNode& a, const ImPlotLineLODNode& b) {
+    if (b.Min < a.Min) { a.Min = b.Min; a.IdxMin = b.IdxMin; }
+    if (b.Max > a.Max) { a.Max = b.Max; a.IdxMax = b.IdxMax; }
+}
+
+template <typename _Getter>
+static inline void ScanLOD(const _Getter& getter, int a, int b, ImPlotLineLODNode& node) {
+    for (int i = a; i < b; ++i) {
+        double y = getter(i).y;
+        if (y < node.Min) { node.Min = y; node.IdxMin = i; }
+        if (y > node.Max) { node.Max = y; node.IdxMax = i; }
+    }
+}
+
+static inline ImPlotLineLODNode EmptyLOD() {
+    ImPlotLineLODNode node;
+    node.Min = HUGE_VAL; node.Max = -HUGE_VAL;
+    node.IdxMin = node.IdxMax = -1;
+    return node;
+}
+
+// Brings the pyramid in line with the getter. Under the version it was built
+// from, unchanged data costs one getter call and appended points or a changed
+// last point only rebuild the trailing blocks and their ancestors. Data is only
+// known to be unchanged through the version: sampling it cannot see an edit in
+// between. Unversioned lines are rebuilt once per frame, fit and render share it.
+template <typename _Getter>
+static void UpdateLOD(ImPlotLineLOD& lod, const _Getter& getter) {
+    const ImPlotNextItemData& next = GImPlot->NextItemData;
+    const int count = getter.Count;
+    int from = 0;
+    if (next.HasLODVersion) {
+        if (lod.HasVersion && lod.Version == next.LODVersion && lod.Count > 1 && count >= lod.Count) {
+            ImPlotPoint last = getter(lod.Count - 1);
+            if (count == lod.Count && last.x == lod.LastX && last.y == lod.LastY)
+                return;
+            from = lod.Count - 1;
+        }
+    }
+    else if (!lod.HasVersion && lod.Frame == ImGui::GetFrameCount() && lod.Count == count) {
+        return;
+    }
+    // level 0 from the raw points
+    const int blocks = (count + IMPLOT_LOD_BLOCK - 1) / IMPLOT_LOD_BLOCK;
+    int first = from / IMPLOT_LOD_BLOCK;
+    lod.Levels[0].resize(blocks);
+    for (int j = first; j < blocks; ++j) {
+        ImPlotLineLODNode node = EmptyLOD();
+        ScanLOD(getter, j * IMPLOT_LOD_BLOCK, ImMin((j + 1) * IMPLOT_LOD_BLOCK, count), node);
+        lod.Levels[0][j] = node;
+    }
+    // parents of every touched node
+    lod.LevelCount = 1;
+    for (int k = 1; k < IMPLOT_LOD_MAX_LEVELS && lod.Levels[k-1].Size > 1; ++k) {
+        const ImVector<ImPlotLineLODNode>& child = lod.Levels[k-1];
+        ImVector<ImPlotLineLODNode>& level = lod.Levels[k];
+        level.resize((child.Size + 1) / 2);
+        first /= 2;
+        for (int j = first; j < level.Size; ++j) {
+            level[j] = child[2*j];
+            if (2*j + 1 < child.Size)
+                CombineLOD(level[j], child[2*j+1]);
+        }
+        lod.LevelCount = k + 1;
+    }
+    lod.Count      = count;
+    lod.HasVersion = next.HasLODVersion;
+    lod.Version    = next.LODVersion;
+    lod.Frame      = ImGui::GetFrameCount();
+    ImPlotPoint last = getter(count - 1);
+    lod.LastX = last.x;
+    lod.LastY = last.y;
+}
+
+// Min/max of y over points [a,b): partial blocks at either end are scanned,
+// whole blocks are covered by at most two nodes per level.
+template <typename _Getter>
+static ImPlotLineLODNode QueryLOD(const ImPlotLineLOD& lod, const _Getter& getter, int a, int b) {
+    ImPlotLineLODNode node = EmptyLOD();
+    int lo = (a + IMPLOT_LOD_BLOCK - 1) / IMPLOT_LOD_BLOCK;
+    int hi = b / IMPLOT_LOD_BLOCK;
+    if (lo >= hi) {
+        ScanLOD(getter, a, b, node);
+        return node;
+    }
+    ScanLOD(getter, a, lo * IMPLOT_LOD_BLOCK, node);
+    ScanLOD(getter, hi * IMPLOT_LOD_BLOCK, b, node);
+    for (int k = 0; lo < hi && k < lod.LevelCount; ++k, lo /= 2, hi /= 2) {
+        if (lo & 1) CombineLOD(node, lod.Levels[k][lo++]);
+        if (hi & 1) CombineLOD(node, lod.Levels[k][--hi]);
+    }
+    return node;
+}
+
+static inline ImPlotLineLOD& GetItemLOD() {
+    ImPlotItem* item = GetCurrentItem();
+    if (item->LOD == nullptr)
+        item->LOD = IM_NEW(ImPlotLineLOD)();
+    return *item->LOD;
+}
+
+/// Fits through the pyramid instead of visiting every point. With RangeFit on
+/// the y-axis only the points inside the current x range contribute.
+template <typename _Getter>
+struct FitterLOD {
+    FitterLOD(const _Getter& getter) : Getter(getter) { }
+    void Fit(ImPlotAxis& x_axis, ImPlotAxis& y_axis) const {
+        if (Getter.Count <= 0)
+            return;
+        ImPlotLineLOD& lod = GetItemLOD();
+        UpdateLOD(lod, Getter);
+        x_axis.ExtendFit(Getter(0).x);
+        x_axis.ExtendFit(Getter(Getter.Count - 1).x);
+        int a = 0, b = Getter.Count;
+        if (ImHasFlag(y_axis.Flags, ImPlotAxisFlags_RangeFit)) {
+            a = LowerBoundX(Getter, 0, Getter.Count, x_axis.Range.Min);
+            b = UpperBoundX(Getter, a, Getter.Count, x_axis.Range.Max);
+        }
+        if (a < b) {
+            ImPlotLineLODNode node = QueryLOD(lod, Getter, a, b);
+            y_axis.ExtendFit(node.Min);
+            y_axis.ExtendFit(node.Max);
+        }
+    }
+    const _Getter& Getter;
+};
+
+/// Reduces points [a,b) to at most four per pixel column of the x-axis: the
+/// first, min, max and last point in index order, which draws the same strip
+/// as the full data at this resolution. Returns the number of points written
+/// to xs/ys (which must hold 4 * columns).
+template <typename _Getter>
+static int DownsampleLOD(const ImPlotLineLOD& lod, const _Getter& getter, int a, int b, const ImPlotAxis& x_axis, int columns, double* xs, double* ys) {
+    int n = 0;
+    int i0 = a;
+    for (int c = 0; c < columns && i0 < b; ++c) {
+        int i1 = b;
+        if (c + 1 < columns) {
+            float t = (float)(c + 1) / (float)columns;
+            float pix = x_axis.IsInverted() ? x_axis.PixelMax + (x_axis.PixelMin - x_axis.PixelMax) * t
+                                            : x_axis.PixelMin + (x_axis.PixelMax - x_axis.PixelMin) * t;
+            i1 = LowerBoundX(getter, i0, b, x_axis.PixelsToPlot(pix));
+        }
+        if (i1 - i0 <= 4) {
+            for (int i = i0; i < i1; ++i) {
+                ImPlotPoint p = getter(i);
+                xs[n] = p.x; ys[n++] = p.y;
+            }
+        }
+        else {
+            // A column of NaN gaps has no extremes (index -1); its first and
+            // last points still go in so the gap is drawn.
+            ImPlotLineLODNode node = QueryLOD(lod, getter, i0, i1);
+            int idx[4] = { i0, ImMin(node.IdxMin, node.IdxMax), ImMax(node.IdxMin, node.IdxMax), i1 - 1 };
+            int prev = -1;
+            for (int k = 0; k < 4; ++k) {
+                if (idx[k] < 0 || idx[k] == prev)
+                    continue;
+                ImPlotPoint p = getter(idx[k]);
+                xs[n] = p.x; ys[n++] = p.y;
+                prev = idx[k];
+            }
+        }
+        i0 = i1;
+    }
+    return n;
+}
+
+/// Selects what to draw of a sorted line: the visible points plus one
+/// neighbour on each side so the strip reaches the plot edges. Returns false
+/// with [*offset, *offset + *count) when that range is sparse enough to draw
+/// as is, or true after reducing it per pixel column into TempDouble1/2.
+template <typename _Getter>
+static bool PrepareLOD(const _Getter& getter, int* offset, int* count) {
+    ImPlotContext& gp = *GImPlot;
+    const ImPlotPlot& plot = *gp.CurrentPlot;
+    const ImPlotAxis& x_axis = plot.Axes[plot.CurrentX];
+    ImPlotLineLOD& lod = GetItemLOD();
+    UpdateLOD(lod, getter);
+    int a = LowerBoundX(getter, 0, getter.Count, x_axis.Range.Min);
+    int b = UpperBoundX(getter, a, getter.Count, x_axis.Range.Max);
+    a = ImMax(a - 1, 0);
+    b = ImMin(b + 1, getter.Count);
+    const int columns = ImMax(1, (int)plot.PlotRect.GetWidth());
+    if (b - a <= 2 * columns) {
+        *offset = a;
+        *count  = b - a;
+        return false;
+    }
+    gp.TempDouble1.resize(4 * columns);
+    gp.TempDouble2.resize(4 * columns);
+    *offset = 0;
+    *count  = DownsampleLOD(lod, getter, a, b, x_axis, columns, gp.TempDouble1.Data, gp.TempDouble2.Data);
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] PlotLine
 //-----------------------------------------------------------------------------
 
+template <typename _Getter>
+void RenderLineStrip(const _Getter& getter, ImPlotLineFlags flags, const ImPlotNextItemData& s) {
+    if (getter.Count < 2)
+        return;
+    if (ImHasFlag(flags, ImPlotLineFlags_Shaded) && s.RenderFill) {
+        const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_Fill]);
+        GetterOverrideY<_Getter> getter2(getter, 0);
+        RenderPrimitives2<RendererShaded>(getter,getter2,col_fill);
+    }
+    if (s.RenderLine) {
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
+        RenderPrimitives1<RendererLineStrip>(getter,col_line,s.LineWeight);
+    }
+}
+
+// Downsampled strip held in plain double columns: the line is transformed in one batch.
+static void RenderLineStripXY(const double* xs, const double* ys, int count, ImPlotLineFlags flags, const ImPlotNextItemData& s) {
+    if (count < 2)
+        return;
+    GetterXY<IndexerIdx<double>,IndexerIdx<double>> getter(IndexerIdx<double>(xs,count),IndexerIdx<double>(ys,count),count);
+    if (ImHasFlag(flags, ImPlotLineFlags_Shaded) && s.RenderFill) {
+        const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_Fill]);
+        GetterOverrideY<GetterXY<IndexerIdx<double>,IndexerIdx<double>>> getter2(getter, 0);
+        RenderPrimitives2<RendererShaded>(getter,getter2,col_fill);
+    }
+    if (s.RenderLine) {
+        ImPlotContext& gp = *GImPlot;
+        const ImPlotPlot& plot = *gp.CurrentPlot;
+        gp.TempVec2.resize(count);
+        PlotToPixels(plot.Axes[plot.CurrentX], xs, &gp.TempVec2.Data[0].x, count, 2);
+        PlotToPixels(plot.Axes[plot.CurrentY], ys, &gp.TempVec2.Data[0].y, count, 2);
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
+        RenderPrimitivesEx(RendererLineStripPixels(gp.TempVec2.Data, count, col_line, s.LineWeight), *GetPlotDrawList(), plot.PlotRect);
+    }
+}
+
 template <typename _Getter>
 void PlotLineEx(const char* label_id, const _Getter& getter, ImPlotLineFlags flags) {
-    if (BeginItemEx(label_id, Fitter1<_Getter>(getter), flags, ImPlotCol_Line)) {
+    const bool downsample = ImHasFlag(flags, ImPlotLineFlags_Downsample) &&
+                            !ImHasFlag(flags, ImPlotLineFlags_Segments | ImPlotLineFlags_Loop | ImPlotLineFlags_SkipNaN);
+    if (downsample ? BeginItemEx(label_id, FitterLOD<_Getter>(getter), flags, ImPlotCol_Line)
+                   : BeginItemEx(label_id, Fitter1<_Getter>(getter), flags, ImPlotCol_Line)) {
         if (getter.Count <= 0) {
             EndItem();
             return;
         }
         const ImPlotNextItemData& s = GetItemData();
-        if (getter.Count > 1) {
+        if (downsample) {
+            int offset, count;
+            if (PrepareLOD(getter, &offset, &count)) {
+                ImPlotContext& gp = *GImPlot;
+                RenderLineStripXY(gp.TempDouble1.Data, gp.TempDouble2.Data, count, flags, s);
+            }
+            else {
+                RenderLineStrip(GetterSlice<_Getter>(getter, offset, count), flags, s);
+            }
+        }
+        else if (getter.Count > 1) {
             if (ImHasFlag(flags, ImPlotLineFlags_Shaded) && s.RenderFill) {
                 const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_Fill]);
                 GetterOverrideY<_Getter> getter2(getter, 0);
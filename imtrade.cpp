@@ -17,68 +17,326 @@
 #include "implot.h"
 #include "implot_internal.h"
 #include "livermore.h"
+#include "backtest.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <curl/curl.h>
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
 #include <vector>
-#include <string>
 
 #ifdef _WIN32
 #include <windows.h>        // SetProcessDPIAware()
+#else
+#include <sys/wait.h>       // headless report workers
+#include <unistd.h>
 #endif
 
 #if !SDL_VERSION_ATLEAST(2,0,17)
 #error This backend requires SDL 2.0.17+ because of SDL_RenderGeometry() function
 #endif
 
-template <typename T>
-int binary_search(const T* arr, int l, int r, T x) {
-    if (r >= l) {
-        int mid = l + (r - l) / 2;
-        if (arr[mid] == x)
-            return mid;
-        if (arr[mid] > x)
-            return binary_search(arr, l, mid - 1, x);
-        return binary_search(arr, mid + 1, r, x);
+// Redraw policy. In on-demand mode the main loop sleeps in SDL_WaitEventTimeout()
+// and only renders after input, feed data or while something animates. Every
+// wake-up is followed by a few extra frames so ImGui can settle state that lags
+// one frame behind input (hover, popups, window resizes).
+static const int redraw_cooldown_frames = 3;
+static const int idle_wait_ms           = 1000; // upper bound on sleep, keeps delayed tooltips honest
+static const int blink_wait_ms          = 250;  // text cursor blink while an input field is active
+
+// Registered at startup. Feed producers wake the main loop with SDL_PushEvent().
+static Uint32 feed_event_type = (Uint32)-1;
+
+// Heap accounting. Global operator new and the ImGui allocator both bump these
+// counters so the debug overlay can show what a single frame allocates.
+struct alloc_counter {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> bytes;
+};
+static alloc_counter new_allocs;
+static alloc_counter imgui_allocs;
+
+static inline void alloc_counter_add(alloc_counter* c, size_t sz) {
+    c->count.fetch_add(1, std::memory_order_relaxed);
+    c->bytes.fetch_add(sz, std::memory_order_relaxed);
+}
+
+void* operator new(size_t sz) {
+    alloc_counter_add(&new_allocs, sz);
+    void* ptr = malloc(sz ? sz : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+static void* imgui_counted_malloc(size_t sz, void* user_data) {
+    alloc_counter_add((alloc_counter*)user_data, sz);
+    return malloc(sz);
+}
+static void imgui_counted_free(void* ptr, void*) { free(ptr); }
+
+// Per-frame scratch memory. Everything handed out by frame_alloc() lives until
+// the next frame_arena_reset(). A frame that outgrows the block spills into
+// malloc'ed overflow chunks; the block is then grown once at reset so that a
+// steady-state frame allocates nothing.
+struct frame_arena {
+    char*  data;
+    size_t cap;
+    size_t used;
+    size_t peak;        // bytes requested during the current frame, overflow included
+    void*  overflow;    // singly linked list of spill chunks, first word is the next pointer
+};
+static frame_arena frame_scratch;
+
+static void* frame_alloc(frame_arena* arena, size_t sz, size_t align = 16) {
+    size_t off = (arena->used + align - 1) & ~(align - 1);
+    arena->peak += sz + align;
+    if (off + sz <= arena->cap) {
+        arena->used = off + sz;
+        return arena->data + off;
     }
-    return -1;
+    // Spill: header padded to the maximum alignment we hand out.
+    char* chunk = (char*)malloc(sz + 16);
+    *(void**)chunk = arena->overflow;
+    arena->overflow = chunk;
+    return chunk + 16;
 }
 
-static void plot_candles(const char* label_id, const lv_candles* candles) {
-    static const double half_width = 0.25f;
-    static ImVec4 bull_col = ImVec4(0.000f, 1.000f, 0.441f, 1.000f);
-    static ImVec4 bear_col = ImVec4(0.853f, 0.050f, 0.310f, 1.000f);
+static void frame_arena_reset(frame_arena* arena) {
+    bool spilled = arena->overflow != NULL;
+    while (arena->overflow) {
+        void* next = *(void**)arena->overflow;
+        free(arena->overflow);
+        arena->overflow = next;
+    }
+    if (spilled) {
+        size_t cap = arena->cap ? arena->cap : 64 * 1024;
+        while (cap < arena->peak) cap *= 2;
+        free(arena->data);
+        arena->data = (char*)malloc(cap);
+        arena->cap = cap;
+    }
+    arena->used = 0;
+    arena->peak = 0;
+}
 
-    const double * open  = candles->open;
-    const double * close = candles->close;
-    const double * low   = candles->low;
-    const double * high  = candles->high;
-    const size_t   count = candles->size;
+template <typename T>
+static T* frame_alloc_array(frame_arena* arena, size_t n) {
+    return (T*)frame_alloc(arena, sizeof(T) * n, alignof(T));
+}
+
+// Frame profiler. PROFILE_SCOPE(stage) adds the time until the end of the
+// enclosing block to the current frame's slot, so a stage entered several
+// times per frame accumulates. The overlay plots the last profile_frames
+// frames. Each scope is also a trace span when built with LV_TRACE. Without
+// IMTRADE_PROFILE (Makefile PROFILE=0) only the span is left, and the overlay
+// is not built.
+#ifdef IMTRADE_PROFILE
+enum profile_stage {
+    profile_events,
+    profile_new_frame,
+    profile_candles,
+    profile_render,
+    profile_submit,
+    profile_stage_count,
+};
+static const char* profile_stage_names[profile_stage_count] = { "Events", "NewFrame", "Candles", "Render", "RenderDrawData" };
+static const int   profile_frames = 240;
+
+struct frame_profile {
+    double ms[profile_frames][profile_stage_count];
+    double total_ms[profile_frames];
+    int    vtx[profile_frames];
+    int    idx[profile_frames];
+    int    cmds[profile_frames];
+    int    head;        // slot of the frame being built
+    int    count;       // valid slots, head included
+    bool   ended;       // head holds a finished frame, the next begin moves on
+    Uint64 start;
+    double to_ms;
+};
+static frame_profile profile;
+
+struct profile_scope {
+    profile_stage stage;
+    Uint64        start;
+    explicit profile_scope(profile_stage s) : stage(s), start(SDL_GetPerformanceCounter()) {}
+    ~profile_scope() { profile.ms[profile.head][stage] += (double)(SDL_GetPerformanceCounter() - start) * profile.to_ms; }
+};
 
-    double min_price = candles->low[0];
-    double max_price = candles->high[0];
-    for (size_t i = 1; i < candles->size; i++) {
-        if (candles->low[i] < min_price) min_price = candles->low[i];
-        if (candles->high[i] > max_price) max_price = candles->high[i];
+static void profile_frame_begin() {
+    if (profile.to_ms == 0.0)
+        profile.to_ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    // A frame that never reached profile_frame_end (minimized window) is redone in place.
+    if (profile.count == 0 || profile.ended) {
+        if (profile.count > 0)
+            profile.head = (profile.head + 1) % profile_frames;
+        profile.count = ImMin(profile.count + 1, profile_frames);
     }
+    profile.ended = false;
+    memset(profile.ms[profile.head], 0, sizeof(profile.ms[profile.head]));
+    profile.start = SDL_GetPerformanceCounter();
+}
 
-    double price_range = max_price - min_price;
-    ImPlot::SetupAxesLimits(
-        -1, (double)candles->size + 3,
-        min_price - price_range * 0.1,
-        max_price + price_range * 0.1);
+// Stops the frame clock and records what the frame submitted.
+static void profile_frame_end(const ImDrawData* draw_data) {
+    int cmds = 0;
+    for (const ImDrawList* list : draw_data->CmdLists)
+        cmds += list->CmdBuffer.Size;
+    profile.total_ms[profile.head] = (double)(SDL_GetPerformanceCounter() - profile.start) * profile.to_ms;
+    profile.vtx[profile.head]  = draw_data->TotalVtxCount;
+    profile.idx[profile.head]  = draw_data->TotalIdxCount;
+    profile.cmds[profile.head] = cmds;
+    profile.ended = true;
+}
 
-    ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Linear);
-    ImPlot::SetupAxisFormat(ImAxis_Y1, "$%.2f");
+#define PROFILE_CONCAT_(a, b)   a##b
+#define PROFILE_CONCAT(a, b)    PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage)    profile_scope PROFILE_CONCAT(profile_scope_, __LINE__)(stage); LV_TRACE_SPAN(#stage)
+#define PROFILE_FRAME_BEGIN()   profile_frame_begin()
+#define PROFILE_FRAME_END(dd)   profile_frame_end(dd)
+#else
+#define PROFILE_SCOPE(stage)    LV_TRACE_SPAN(#stage)
+#define PROFILE_FRAME_BEGIN()
+#define PROFILE_FRAME_END(dd)
+#endif
+
+static ImVec4 bull_col = ImVec4(0.000f, 1.000f, 0.441f, 1.000f);
+static ImVec4 bear_col = ImVec4(0.853f, 0.050f, 0.310f, 1.000f);
+
+// Settled candles are rendered once into a target texture and composited as a
+// single quad. plot_candles records the geometry when the key below changes,
+// chart_layer_flush replays it into the texture before the frame is rendered.
+// The live bar, indicators and crosshair are drawn on top every frame.
+struct chart_layer {
+    SDL_Texture* texture;
+    int          tex_w, tex_h;
+    ImDrawList*  geometry;    // relative to the plot's top-left corner
+    ImDrawData   draw_data;
+    bool         dirty;       // geometry recorded, texture not updated yet
+    ImPlotRect   limits;
+    ImVec2       size;
+    ImVec2       scale;
+    size_t       settled;     // bars baked into the texture
+    unsigned     generation;  // chart::generation the bars came from
+    ImU32        bull, bear;
+};
+
+// Set in main when the renderer supports target textures; null disables the layer.
+static SDL_Renderer* layer_renderer = nullptr;
+static bool          layer_cache    = true;
+
+// ImPlot::SetNextLineLOD versions, unique across everything plotted: a line
+// gets a new one whenever its data is replaced rather than appended to.
+static ImU64 plot_version = 0;
+
+static ImU64 next_plot_version() { return ++plot_version; }
+
+enum chart_status {
+    chart_loading,
+    chart_ready,
+    chart_failed,
+};
+
+// A fetched series together with everything derived from it: indicators, the
+// date tick table and the dashboard sparkline. All of it is recomputed when
+// the candles are replaced and extended when bars are appended, never per frame.
+struct chart {
+    const char* symbol;
+    chart_status status;
+    lv_candles staged;      // owned by a fetch worker until handed over via feed_event_type
+    int        staged_result;
+    bool       refit;       // new data arrived, fit the x axis once
+    lv_candles candles;
+    double*    ma;          // simple moving average of close, ma_window bars
+    double*    macd;
+    double*    macd_signal;
+    double*    macd_hist;
+    double*    rsi;
+    lv_indicator_stream stream; // indicator state as of the last extended bar
+    double*    tick_pos;    // bar index of every month (daily) or day (intraday) change
+    char*      tick_text;   // tick_label_len bytes per tick
+    int        tick_count;
+    float*     spark_lo;    // per pixel column close range, spark_cols entries
+    float*     spark_hi;
+    int        spark_cols;
+    int        spark_width; // tile width the columns were built for, 0 when stale
+    unsigned   generation;  // bumped whenever the candles change
+    ImU64      version;     // plot version of the indicator lines, new when the series is replaced
+    int        follow;      // bars kept in view at the live edge, 0 leaves the x axis to the user
+    chart_layer layer;
+};
+
+static const size_t ma_window      = 20;
+static const size_t macd_fast      = 12;
+static const size_t macd_slow      = 26;
+static const size_t macd_signal    = 9;
+static const size_t rsi_period     = 14;
+static const size_t tick_label_len = 8; // "%Y/%m" and "%m/%d" plus terminator
+
+static void chart_init(chart* c, const char* symbol, size_t cap) {
+    c->symbol = symbol;
+    c->status = chart_loading;
+    c->refit  = false;
+    lv_candles_init(&c->staged, cap);
+    lv_candles_init(&c->candles, cap);
+    c->ma          = (double*)malloc(sizeof(double) * cap);
+    c->macd        = (double*)malloc(sizeof(double) * cap);
+    c->macd_signal = (double*)malloc(sizeof(double) * cap);
+    c->macd_hist   = (double*)malloc(sizeof(double) * cap);
+    c->rsi         = (double*)malloc(sizeof(double) * cap);
+    c->tick_pos    = (double*)malloc(sizeof(double) * cap);
+    c->tick_text   = (char*)malloc(tick_label_len * cap);
+    c->tick_count  = 0;
+    c->spark_lo    = nullptr;
+    c->spark_hi    = nullptr;
+    c->spark_cols  = 0;
+    c->spark_width = 0;
+    c->generation  = 0;
+    c->follow      = 0;
+    c->layer.texture  = nullptr;
+    c->layer.geometry = nullptr;
+    c->layer.dirty    = false;
+}
+
+static void chart_free(chart* c) {
+    lv_candles_free(&c->staged);
+    lv_candles_free(&c->candles);
+    free(c->ma);
+    free(c->macd);
+    free(c->macd_signal);
+    free(c->macd_hist);
+    free(c->rsi);
+    free(c->tick_pos);
+    free(c->tick_text);
+    free(c->spark_lo);
+    free(c->spark_hi);
+    if (c->layer.texture)
+        SDL_DestroyTexture(c->layer.texture);
+    IM_DELETE(c->layer.geometry);
+    c->layer.draw_data.CmdLists.clear();
+}
 
-    // Setup custom X-axis ticks with dates - only when day changes
-    static std::vector<double> tick_positions;
-    static std::vector<const char*> tick_labels;
-    static std::vector<std::string> date_strings;
-    tick_positions.clear();
-    tick_labels.clear();
-    date_strings.clear();
+// First bar at which each indicator holds a real value.
+static inline size_t ma_warmup()   { return ma_window - 1; }
+static inline size_t macd_warmup() { return macd_slow + macd_signal - 2; }
+static inline size_t rsi_warmup()  { return rsi_period; }
+
+// Extends the tick table over bars [from, size). The first two bars decide
+// the label kind, so the table is rebuilt while there were fewer than that.
+static void chart_update_ticks(chart* c, size_t from) {
+    const lv_candles* candles = &c->candles;
+    if (from <= 1) {
+        from = 0;
+        c->tick_count = 0;
+    }
     // Detect if this is daily data by checking time interval
     bool is_daily = false;
     if (candles->size > 1) {
@@ -86,37 +344,505 @@ static void plot_candles(const char* label_id, const lv_candles* candles) {
         is_daily = (interval >= 86400); // 24 hours or more
     }
 
-    char date_buf[16];
-    if (is_daily) {
-        // For daily data, show month changes
-        int prev_month = -1;
-        for (size_t i = 0; i < candles->size; i++) {
-            struct tm* tm_info = localtime(&candles->timestamp[i]);
-            if (i == 0 || tm_info->tm_mon != prev_month) {
-                tick_positions.push_back((double)i);
-                strftime(date_buf, sizeof(date_buf), "%Y/%m", tm_info);
-                date_strings.emplace_back(date_buf);
-                tick_labels.push_back(date_strings.back().c_str());
-                prev_month = tm_info->tm_mon;
-            }
+    // Daily data shows month changes, intraday data shows day changes
+    int prev = -1;
+    if (from > 0) {
+        struct tm* tm_info = localtime(&candles->timestamp[from - 1]);
+        prev = is_daily ? tm_info->tm_mon : tm_info->tm_mday;
+    }
+    for (size_t i = from; i < candles->size; i++) {
+        struct tm* tm_info = localtime(&candles->timestamp[i]);
+        int key = is_daily ? tm_info->tm_mon : tm_info->tm_mday;
+        if (i == 0 || key != prev) {
+            char* label = c->tick_text + tick_label_len * c->tick_count;
+            strftime(label, tick_label_len, is_daily ? "%Y/%m" : "%m/%d", tm_info);
+            c->tick_pos[c->tick_count++] = (double)i;
+            prev = key;
         }
-    } else {
-        // For intraday data, show day changes
-        int prev_day = -1;
-        for (size_t i = 0; i < candles->size; i++) {
-            struct tm* tm_info = localtime(&candles->timestamp[i]);
-            if (i == 0 || tm_info->tm_mday != prev_day) {
-                tick_positions.push_back((double)i);
-                strftime(date_buf, sizeof(date_buf), "%m/%d", tm_info);
-                date_strings.emplace_back(date_buf);
-                tick_labels.push_back(date_strings.back().c_str());
-                prev_day = tm_info->tm_mday;
-            }
+    }
+}
+
+// Brings indicators and ticks up to date after bars from `from` on were
+// appended, the path a live feed takes. Cost follows the new bars only.
+static void chart_extend(chart* c, size_t from) {
+    LV_TRACE_SPAN("chart_extend");
+    lv_indicator_stream_update(&c->stream, c->candles.size, c->candles.close, c->ma, c->macd, c->macd_signal, c->macd_hist, c->rsi);
+    chart_update_ticks(c, from);
+    c->spark_width = 0;
+    c->generation++;
+}
+
+static void chart_update(chart* c) {
+    LV_TRACE_SPAN("chart_update");
+    lv_indicator_stream_init(&c->stream, ma_window, macd_fast, macd_slow, macd_signal, rsi_period);
+    c->version = next_plot_version();
+    chart_extend(c, 0);
+}
+
+// Takes over a finished fetch. Runs on the UI thread when the worker's
+// feed_event_type event is handled, so drawing never sees a half-written series.
+static void chart_adopt(chart* c) {
+    if (c->staged_result != 0 || c->staged.size == 0) {
+        c->status = chart_failed;
+        return;
+    }
+    lv_candles tmp = c->candles;
+    c->candles = c->staged;
+    c->staged  = tmp;
+    c->status  = chart_ready;
+    c->refit   = true;
+    chart_update(c);
+}
+
+// Background loader. A few workers pull charts off a shared counter, fetch
+// into chart::staged and post feed_event_type with the chart as data1.
+struct chart_loader {
+    chart*                   charts;
+    size_t                   count;
+    const char*              market;
+    const char*              interval;
+    std::atomic<size_t>      next;
+    std::atomic<bool>        quit;
+    std::vector<std::thread> workers;
+};
+
+static const int fetch_threads = 4;
+
+static void chart_loader_run(chart_loader* l) {
+    LV_TRACE_THREAD("fetch");
+    for (;;) {
+        size_t i = l->next.fetch_add(1);
+        if (i >= l->count || l->quit.load())
+            return;
+        chart* c = &l->charts[i];
+        c->staged_result = lv_candles_fetch(&c->staged, l->market, c->symbol, l->interval);
+        SDL_Event event = {};
+        event.type = feed_event_type;
+        event.user.data1 = c;
+        SDL_PushEvent(&event);
+    }
+}
+
+static void chart_loader_start(chart_loader* l, chart* charts, size_t count, const char* market, const char* interval) {
+    l->charts   = charts;
+    l->count    = count;
+    l->market   = market;
+    l->interval = interval;
+    l->next     = 0;
+    l->quit     = false;
+    for (int i = 0; i < fetch_threads && (size_t)i < count; i++)
+        l->workers.emplace_back(chart_loader_run, l);
+}
+
+// Waits for in-flight fetches only; queued charts are skipped.
+static void chart_loader_stop(chart_loader* l) {
+    l->quit = true;
+    for (std::thread& t : l->workers)
+        t.join();
+    l->workers.clear();
+}
+
+// Rebuilds the per-pixel-column close range when the tile width or the data
+// changed, and reuses it untouched otherwise. With fewer bars than pixels
+// every bar gets its own column.
+static void chart_update_sparkline(chart* c, int width) {
+    if (c->spark_width == width)
+        return;
+    const size_t n = c->candles.size;
+    if (c->spark_width < width) {
+        c->spark_lo = (float*)realloc(c->spark_lo, sizeof(float) * width);
+        c->spark_hi = (float*)realloc(c->spark_hi, sizeof(float) * width);
+    }
+    c->spark_cols  = (int)ImMin((size_t)width, n);
+    c->spark_width = width;
+    for (int col = 0; col < c->spark_cols; col++) {
+        size_t a = n * col / c->spark_cols;
+        size_t b = n * (col + 1) / c->spark_cols;
+        double lo = c->candles.close[a], hi = lo;
+        for (size_t i = a + 1; i < b; i++) {
+            lo = ImMin(lo, c->candles.close[i]);
+            hi = ImMax(hi, c->candles.close[i]);
         }
+        c->spark_lo[col] = (float)lo;
+        c->spark_hi[col] = (float)hi;
+    }
+}
+
+// Visible bar range [first, last) of a chart. It is computed once per frame in
+// the price pane and shared by every pane below it, so per-candle work tracks
+// what is on screen rather than series length times pane count.
+struct chart_view {
+    int first;
+    int last;
+};
+
+// Per-frame state shared by the linked panes of one chart.
+struct chart_frame {
+    chart_view   view;
+    double*      tick_pos;      // thinned ticks, frame arena
+    const char** tick_labels;
+    int          tick_count;
+};
+
+static chart_view chart_view_from_range(const ImPlotRange& x, size_t count) {
+    chart_view v;
+    double lo = ImFloor(x.Min), hi = ImCeil(x.Max) + 1.0;
+    v.first = (int)ImClamp(lo, 0.0, (double)count);
+    v.last  = (int)ImClamp(hi, 0.0, (double)count);
+    return v;
+}
+
+// The view for the pane being set up: the shared culled range, or the whole
+// series on the frame this pane's x axis is being fit to its data.
+static chart_view pane_view(const chart_frame* f, size_t count) {
+    if (ImPlot::GetCurrentPlot()->Axes[ImAxis_X1].FitThisFrame) {
+        chart_view all = { 0, (int)count };
+        return all;
+    }
+    return f->view;
+}
+
+// Picks the cached date ticks within [lo, hi] and thins them so labels stay
+// readable. Thinning keeps every stride-th tick of the whole table, with a
+// power-of-two stride, so labels do not jump around while panning.
+static void chart_frame_ticks(chart_frame* f, const chart* c, double lo, double hi, float plot_px) {
+    const double* begin = c->tick_pos;
+    const double* end   = c->tick_pos + c->tick_count;
+    int a = (int)(std::lower_bound(begin, end, lo) - begin);
+    int b = (int)(std::upper_bound(begin, end, hi) - begin);
+    float label_px = ImGui::CalcTextSize("0000/00").x * 2.0f;
+    int max_labels = ImMax(1, (int)(plot_px / label_px));
+    int stride = 1;
+    while ((b - a) / stride > max_labels) stride *= 2;
+    a = (a + stride - 1) / stride * stride;
+    int n = b > a ? (b - a + stride - 1) / stride : 0;
+
+    f->tick_pos    = frame_alloc_array<double>(&frame_scratch, n);
+    f->tick_labels = frame_alloc_array<const char*>(&frame_scratch, n);
+    f->tick_count  = 0;
+    for (int i = a; i < b; i += stride) {
+        f->tick_pos[f->tick_count]      = c->tick_pos[i];
+        f->tick_labels[f->tick_count++] = c->tick_text + tick_label_len * i;
+    }
+}
+
+static void setup_pane_ticks(const chart_frame* f) {
+    ImPlot::SetupAxisTicks(ImAxis_X1, f->tick_pos, f->tick_count, f->tick_labels);
+}
+
+// Bar under the cursor. The x axis is the bar index, so this is a rounding
+// rather than a search; returns -1 outside the series.
+static int bar_at(double x, size_t count) {
+    double idx = x + 0.5;
+    if (idx < 0.0 || idx >= (double)count)
+        return -1;
+    return (int)idx;
+}
+
+static int volume_formatter(double value, char* buff, int size, void*) {
+    if (value >= 1e9) return snprintf(buff, size, "%.1fB", value * 1e-9);
+    if (value >= 1e6) return snprintf(buff, size, "%.1fM", value * 1e-6);
+    if (value >= 1e3) return snprintf(buff, size, "%.1fK", value * 1e-3);
+    return snprintf(buff, size, "%.0f", value);
+}
+
+// Persistent workers for filling large meshes. geometry_pool_run hands out
+// chunks through a shared counter, works on them itself and returns once every
+// chunk is written; the draw list is never touched off the UI thread except
+// for the pre-reserved slices the job writes into.
+struct geometry_pool {
+    std::vector<std::thread> workers;
+    std::mutex               lock;
+    std::condition_variable  wake;
+    std::condition_variable  idle;
+    void                   (*job)(void* arg, int chunk);
+    void*                    arg;
+    int                      chunks;
+    std::atomic<int>         next;
+    int                      busy;   // workers still inside the current batch
+    unsigned                 batch;  // bumped per run, workers wait for it to change
+    bool                     quit;
+};
+
+static geometry_pool geometry_workers;
+static bool          parallel_geometry   = true;
+static const int     geometry_min_bars   = 16384; // below this a batch costs more than it saves
+static const int     geometry_chunk_bars = 4096;
+
+static void geometry_pool_drain(geometry_pool* p) {
+    for (int i = p->next.fetch_add(1); i < p->chunks; i = p->next.fetch_add(1))
+        p->job(p->arg, i);
+}
+
+static void geometry_pool_worker(geometry_pool* p) {
+    LV_TRACE_THREAD("geometry");
+    unsigned seen = 0;
+    std::unique_lock<std::mutex> lk(p->lock);
+    for (;;) {
+        p->wake.wait(lk, [&] { return p->quit || p->batch != seen; });
+        if (p->quit)
+            return;
+        seen = p->batch;
+        lk.unlock();
+        geometry_pool_drain(p);
+        lk.lock();
+        if (--p->busy == 0)
+            p->idle.notify_one();
     }
-    ImPlot::SetupAxisTicks(
-        ImAxis_X1, tick_positions.data(),
-        (int)tick_positions.size(), tick_labels.data());
+}
+
+static void geometry_pool_start(geometry_pool* p) {
+    unsigned n = std::thread::hardware_concurrency();
+    p->quit  = false;
+    p->batch = 0;
+    for (unsigned i = 1; i < n && i < 16; i++)
+        p->workers.emplace_back(geometry_pool_worker, p);
+}
+
+static void geometry_pool_stop(geometry_pool* p) {
+    {
+        std::lock_guard<std::mutex> lk(p->lock);
+        p->quit = true;
+    }
+    p->wake.notify_all();
+    for (std::thread& t : p->workers)
+        t.join();
+    p->workers.clear();
+}
+
+static void geometry_pool_run(geometry_pool* p, void (*job)(void*, int), void* arg, int chunks) {
+    {
+        std::lock_guard<std::mutex> lk(p->lock);
+        p->job    = job;
+        p->arg    = arg;
+        p->chunks = chunks;
+        p->next   = 0;
+        p->busy   = (int)p->workers.size();
+        p->batch++;
+    }
+    p->wake.notify_all();
+    geometry_pool_drain(p);
+    std::unique_lock<std::mutex> lk(p->lock);
+    p->idle.wait(lk, [&] { return p->busy == 0; });
+}
+
+// Candle mesh for a reserved span of the draw list: per bar a 1px wick quad and
+// a body quad, 8 vertices and 12 indices, so any bar's slice is known up front.
+struct candle_job {
+    const lv_candles* candles;
+    const ImPlotAxis* x_axis;
+    const ImPlotAxis* y_axis;
+    int               first, last;
+    ImVec2            origin;
+    ImVec2            uv;
+    ImU32             bull, bear;
+    ImDrawVert*       vtx;
+    ImDrawIdx*        idx;
+    unsigned int      base;   // vertex index of bar `first`
+};
+
+static const int candle_vtx = 8;
+static const int candle_idx = 12;
+
+static inline void write_quad(ImDrawVert* vtx, ImDrawIdx* idx, unsigned int base, float x0, float y0, float x1, float y1, ImVec2 uv, ImU32 col) {
+    vtx[0].pos = ImVec2(x0, y0); vtx[0].uv = uv; vtx[0].col = col;
+    vtx[1].pos = ImVec2(x1, y0); vtx[1].uv = uv; vtx[1].col = col;
+    vtx[2].pos = ImVec2(x1, y1); vtx[2].uv = uv; vtx[2].col = col;
+    vtx[3].pos = ImVec2(x0, y1); vtx[3].uv = uv; vtx[3].col = col;
+    idx[0] = (ImDrawIdx)base; idx[1] = (ImDrawIdx)(base + 1); idx[2] = (ImDrawIdx)(base + 2);
+    idx[3] = (ImDrawIdx)base; idx[4] = (ImDrawIdx)(base + 2); idx[5] = (ImDrawIdx)(base + 3);
+}
+
+// Coordinates go through ImPlot's batch transform a block of bars at a time.
+static void write_candles(const candle_job* j, int first, int last) {
+    LV_TRACE_SPAN("write_candles");
+    static const double half_width = 0.25f;
+    static const int    block      = 256;
+    const double * open  = j->candles->open;
+    const double * close = j->candles->close;
+    const double * low   = j->candles->low;
+    const double * high  = j->candles->high;
+    double xs[3][block];
+    float  px[3][block];  // left, centre, right
+    float  py[4][block];  // open, close, low, high
+    const int r = first - j->first;
+    ImDrawVert*  vtx  = j->vtx + r * candle_vtx;
+    ImDrawIdx*   idx  = j->idx + r * candle_idx;
+    unsigned int base = j->base + (unsigned int)(r * candle_vtx);
+    const float ox = j->origin.x, oy = j->origin.y;
+    for (int a = first; a < last; a += block) {
+        const int n = ImMin(block, last - a);
+        for (int k = 0; k < n; ++k) {
+            xs[0][k] = (a + k) - half_width;
+            xs[1][k] = (a + k);
+            xs[2][k] = (a + k) + half_width;
+        }
+        for (int c = 0; c < 3; ++c)
+            ImPlot::PlotToPixels(*j->x_axis, xs[c], px[c], n);
+        ImPlot::PlotToPixels(*j->y_axis, open + a, py[0], n);
+        ImPlot::PlotToPixels(*j->y_axis, close + a, py[1], n);
+        ImPlot::PlotToPixels(*j->y_axis, low + a, py[2], n);
+        ImPlot::PlotToPixels(*j->y_axis, high + a, py[3], n);
+        for (int k = 0; k < n; ++k) {
+            const float x = px[1][k] - ox;
+            ImU32 col = open[a + k] > close[a + k] ? j->bear : j->bull;
+            write_quad(vtx, idx, base, x - 0.5f, py[3][k] - oy, x + 0.5f, py[2][k] - oy, j->uv, col);
+            write_quad(vtx + 4, idx + 6, base + 4, px[0][k] - ox, py[0][k] - oy, px[2][k] - ox, py[1][k] - oy, j->uv, col);
+            vtx += candle_vtx; idx += candle_idx; base += candle_vtx;
+        }
+    }
+}
+
+static void candle_job_run(void* arg, int chunk) {
+    const candle_job* j = (const candle_job*)arg;
+    int first = j->first + chunk * geometry_chunk_bars;
+    write_candles(j, first, ImMin(first + geometry_chunk_bars, j->last));
+}
+
+// Bars [first, last) as wicks and bodies, shifted by -origin. Large spans are
+// reserved in one go and filled by the geometry workers; with 16-bit indices a
+// reservation must stay under 64K vertices, so those are written serially.
+static void draw_candles(ImDrawList* draw_list, const lv_candles* candles, int first, int last, ImVec2 origin, ImU32 bull, ImU32 bear) {
+    ImPlotPlot* plot = ImPlot::GetCurrentPlot();
+    candle_job j;
+    j.candles = candles;
+    j.x_axis  = &plot->Axes[plot->CurrentX];
+    j.y_axis  = &plot->Axes[plot->CurrentY];
+    j.origin  = origin;
+    j.uv      = draw_list->_Data->TexUvWhitePixel;
+    j.bull    = bull;
+    j.bear    = bear;
+    const int block = sizeof(ImDrawIdx) == 2 ? (1 << 16) / candle_vtx - 1 : last - first;
+    for (int a = first; a < last; a += block) {
+        const int b = ImMin(a + block, last);
+        const int bars = b - a;
+        draw_list->PrimReserve(bars * candle_idx, bars * candle_vtx);
+        j.first = a;
+        j.last  = b;
+        j.vtx   = draw_list->_VtxWritePtr;
+        j.idx   = draw_list->_IdxWritePtr;
+        j.base  = draw_list->_VtxCurrentIdx;
+        if (parallel_geometry && !geometry_workers.workers.empty() && bars >= geometry_min_bars)
+            geometry_pool_run(&geometry_workers, candle_job_run, &j, (bars + geometry_chunk_bars - 1) / geometry_chunk_bars);
+        else
+            write_candles(&j, a, b);
+        draw_list->_VtxWritePtr   += bars * candle_vtx;
+        draw_list->_IdxWritePtr   += bars * candle_idx;
+        draw_list->_VtxCurrentIdx += bars * candle_vtx;
+    }
+}
+
+static bool chart_layer_valid(const chart_layer* l, const chart* c, size_t settled, ImVec2 size, ImVec2 scale, ImU32 bull, ImU32 bear) {
+    const ImPlotRect lim = ImPlot::GetPlotLimits();
+    return l->texture && l->settled > 0 && l->generation == c->generation && l->settled == settled &&
+           l->size.x == size.x && l->size.y == size.y && l->scale.x == scale.x && l->scale.y == scale.y &&
+           l->limits.X.Min == lim.X.Min && l->limits.X.Max == lim.X.Max &&
+           l->limits.Y.Min == lim.Y.Min && l->limits.Y.Max == lim.Y.Max &&
+           l->bull == bull && l->bear == bear;
+}
+
+// Records bars [first, last) for the texture, (re)creating it at the plot's
+// pixel size. Colour only, no font texture: the list is replayed outside the
+// ImGui frame. Returns false when no target texture can be had.
+static bool chart_layer_record(chart_layer* l, const chart* c, int first, int last, size_t settled, ImVec2 origin, ImVec2 size, ImVec2 scale, ImU32 bull, ImU32 bear) {
+    int w = (int)(size.x * scale.x + 0.5f);
+    int h = (int)(size.y * scale.y + 0.5f);
+    if (w <= 0 || h <= 0)
+        return false;
+    if (l->texture == nullptr || l->tex_w != w || l->tex_h != h) {
+        if (l->texture)
+            SDL_DestroyTexture(l->texture);
+        l->texture = SDL_CreateTexture(layer_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (l->texture == nullptr)
+            return false;
+        l->tex_w = w;
+        l->tex_h = h;
+        // Blending into a cleared target leaves premultiplied colour behind. The
+        // software renderer has no custom modes; plain blending only darkens AA edges.
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                                                 SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        if (SDL_SetTextureBlendMode(l->texture, premultiplied) != 0)
+            SDL_SetTextureBlendMode(l->texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(l->texture, SDL_ScaleModeNearest);
+    }
+
+    if (l->geometry == nullptr)
+        l->geometry = IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData());
+    ImDrawList* dl = l->geometry;
+    dl->_ResetForNewFrame();
+    dl->Flags &= ~ImDrawListFlags_AntiAliasedLinesUseTex;
+    dl->PushClipRect(ImVec2(0, 0), size);
+    draw_candles(dl, &c->candles, first, last, origin, bull, bear);
+    dl->PopClipRect();
+    l->limits     = ImPlot::GetPlotLimits();
+    l->size       = size;
+    l->scale      = scale;
+    l->settled    = settled;
+    l->generation = c->generation;
+    l->bull       = bull;
+    l->bear       = bear;
+    l->dirty      = true;
+    return true;
+}
+
+// Replays recorded geometry into the layer texture. Call between ImGui::Render()
+// and rendering the frame's draw data.
+static void chart_layer_flush(chart_layer* l, SDL_Renderer* renderer) {
+    if (!l->dirty)
+        return;
+    l->dirty = false;
+
+    ImDrawData* dd = &l->draw_data;
+    dd->Clear();
+    dd->Valid            = true;
+    dd->DisplayPos       = ImVec2(0, 0);
+    dd->DisplaySize      = l->size;
+    dd->FramebufferScale = ImVec2(1, 1); // scale is applied by SDL_RenderSetScale below
+    dd->AddDrawList(l->geometry);
+
+    SDL_BlendMode blend;
+    SDL_GetRenderDrawBlendMode(renderer, &blend);
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, l->texture);
+    SDL_RenderSetScale(renderer, l->scale.x, l->scale.y);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    ImGui_ImplSDLRenderer2_RenderDrawData(dd, renderer);
+    SDL_SetRenderDrawBlendMode(renderer, blend);
+    SDL_SetRenderTarget(renderer, target);
+}
+
+static void plot_candles(const char* label_id, chart* c, chart_frame* f, bool tooltip) {
+    static const double half_width = 0.25f;
+
+    const lv_candles* candles = &c->candles;
+    const double * open  = candles->open;
+    const double * close = candles->close;
+    const double * low   = candles->low;
+    const double * high  = candles->high;
+    const size_t   count = candles->size;
+
+    if (c->follow > 0)
+        ImPlot::SetupAxisLimits(ImAxis_X1, ImMax(-1.0, (double)count - c->follow), (double)count + 3, ImPlotCond_Always);
+    else
+        ImPlot::SetupAxisLimits(ImAxis_X1, -1, (double)count + 3, c->refit ? ImPlotCond_Always : ImPlotCond_Once);
+    c->refit = false;
+    ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Linear);
+    ImPlot::SetupAxisFormat(ImAxis_Y1, "$%.2f");
+
+    // Ticks have to be set up before the axes lock, i.e. before this frame's
+    // pan/zoom is applied. Pad last frame's range by its width so a frame of
+    // panning never runs out of labels.
+    ImPlotPlot* plot = ImPlot::GetCurrentPlot();
+    ImPlotRange x_prev = plot->Axes[ImAxis_X1].Range;
+    float plot_px = plot->PlotRect.GetWidth() > 0 ? plot->PlotRect.GetWidth() : ImGui::GetContentRegionAvail().x;
+    chart_frame_ticks(f, c, x_prev.Min - x_prev.Size(), x_prev.Max + x_prev.Size(), plot_px * 3.0f);
+    setup_pane_ticks(f);
+
+    // Locks the setup; from here on the limits are final for this frame.
+    f->view = chart_view_from_range(ImPlot::GetPlotLimits().X, count);
+    const chart_view v = pane_view(f, count);
 
     // get ImGui window DrawList
     ImDrawList* draw_list = ImPlot::GetPlotDrawList();
@@ -127,59 +853,1533 @@ static void plot_candles(const char* label_id, const lv_candles* candles) {
 
         // fit data if requested
         if (ImPlot::FitThisFrame()) {
-            for (int i = 0; i < count; ++i) {
+            for (int i = v.first; i < v.last; ++i) {
                 ImPlot::FitPoint(ImPlotPoint(i, low[i]));
                 ImPlot::FitPoint(ImPlotPoint(i, high[i]));
             }
         }
 
-        // render data
-        for (int i = 0; i < count; ++i) {
-            ImVec2 open_pos  = ImPlot::PlotToPixels(i - half_width, open[i]);
-            ImVec2 close_pos = ImPlot::PlotToPixels(i + half_width, close[i]);
-            ImVec2 low_pos   = ImPlot::PlotToPixels(i, low[i]);
-            ImVec2 high_pos  = ImPlot::PlotToPixels(i, high[i]);
-            ImU32 color      = ImGui::GetColorU32(open[i] > close[i] ? bear_col : bull_col);
-            draw_list->AddLine(low_pos, high_pos, color);
-            draw_list->AddRectFilled(open_pos, close_pos, color);
+        // render data: settled bars through the layer texture when possible, the live bar always directly
+        const ImU32 bull = ImGui::GetColorU32(bull_col);
+        const ImU32 bear = ImGui::GetColorU32(bear_col);
+        const int live = (int)count - 1;
+        chart_layer* l = &c->layer;
+        ImVec2 pos   = ImPlot::GetPlotPos();
+        ImVec2 size  = ImPlot::GetPlotSize();
+        ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+        if (layer_cache && layer_renderer && live > 0 &&
+            (chart_layer_valid(l, c, (size_t)live, size, scale, bull, bear) ||
+             chart_layer_record(l, c, v.first, ImMin(v.last, live), (size_t)live, pos, size, scale, bull, bear))) {
+            draw_list->AddImage((ImTextureID)(intptr_t)l->texture, pos, ImVec2(pos.x + size.x, pos.y + size.y));
+            if (v.last > live)
+                draw_candles(draw_list, candles, live, v.last, ImVec2(0, 0), bull, bear);
+        }
+        else {
+            draw_candles(draw_list, candles, v.first, v.last, ImVec2(0, 0), bull, bear);
         }
 
         // end plot item
         ImPlot::EndItem();
     }
 
-    // custom tool
-//    if (ImPlot::IsPlotHovered() && tooltip) {
-//        ImPlotPoint mouse   = ImPlot::GetPlotMousePos();
-//        mouse.x             = ImPlot::RoundTime(ImPlotTime::FromDouble(mouse.x), ImPlotTimeUnit_Day).ToDouble();
-//        float  tool_l       = ImPlot::PlotToPixels(mouse.x - half_width * 1.5, mouse.y).x;
-//        float  tool_r       = ImPlot::PlotToPixels(mouse.x + half_width * 1.5, mouse.y).x;
-//        float  tool_t       = ImPlot::GetPlotPos().y;
-//        float  tool_b       = tool_t + ImPlot::GetPlotSize().y;
-//        ImPlot::PushPlotClipRect();
-//        draw_list->AddRectFilled(ImVec2(tool_l, tool_t), ImVec2(tool_r, tool_b), IM_COL32(128,128,128,64));
-//        ImPlot::PopPlotClipRect();
-//        // find mouse location index using binary search
-//        int idx = binary_search(xs, 0, count - 1, mouse.x);
-//        if (idx >= 0 && idx < count) {
-//            ImGui::BeginTooltip();
-//            if (timestamps) {
-//                char buff[32];
-//                struct tm* tm_info = localtime(&timestamps[idx]);
-//                strftime(buff, sizeof(buff), "%Y-%m-%d", tm_info);
-//                ImGui::Text("Date:  %s", buff);
-//            }
-//            ImGui::Text("Open:  $%.2f", open[idx]);
-//            ImGui::Text("Close: $%.2f", close[idx]);
-//            ImGui::Text("Low:   $%.2f", low[idx]);
-//            ImGui::Text("High:  $%.2f", high[idx]);
-//            ImGui::EndTooltip();
-//        }
-//    }
+    // Indicator lines go in whole; ImPlot culls and downsamples sorted series itself.
+    if (count > ma_window) {
+        ImPlot::SetNextLineStyle(ImVec4(1.0f, 0.8f, 0.2f, 1.0f));
+        ImPlot::SetNextLineLOD(c->version);
+        ImPlot::PlotLine("MA20", c->ma + ma_warmup(), (int)(count - ma_warmup()), 1.0, (double)ma_warmup(), ImPlotLineFlags_Downsample);
+    }
+
+    // crosshair and tooltip for the bar under the cursor
+    if (ImPlot::IsPlotHovered() && tooltip) {
+        ImPlotPoint mouse = ImPlot::GetPlotMousePos();
+        int idx = bar_at(mouse.x, count);
+        float plot_l = ImPlot::GetPlotPos().x;
+        float plot_r = plot_l + ImPlot::GetPlotSize().x;
+        float plot_t = ImPlot::GetPlotPos().y;
+        float plot_b = plot_t + ImPlot::GetPlotSize().y;
+        ImVec2 mouse_pos = ImPlot::PlotToPixels(mouse);
+        ImPlot::PushPlotClipRect();
+        if (idx >= 0) {
+            float tool_l = ImPlot::PlotToPixels(idx - half_width * 1.5, mouse.y).x;
+            float tool_r = ImPlot::PlotToPixels(idx + half_width * 1.5, mouse.y).x;
+            draw_list->AddRectFilled(ImVec2(tool_l, plot_t), ImVec2(tool_r, plot_b), IM_COL32(128,128,128,64));
+        }
+        draw_list->AddLine(ImVec2(plot_l, mouse_pos.y), ImVec2(plot_r, mouse_pos.y), IM_COL32(200,200,200,128));
+        draw_list->AddLine(ImVec2(mouse_pos.x, plot_t), ImVec2(mouse_pos.x, plot_b), IM_COL32(200,200,200,128));
+        ImPlot::PopPlotClipRect();
+        ImPlot::TagY(mouse.y, ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "%.2f", mouse.y);
+
+        if (idx >= 0) {
+            char buff[32];
+            struct tm* tm_info = localtime(&candles->timestamp[idx]);
+            strftime(buff, sizeof(buff), "%Y-%m-%d %H:%M", tm_info);
+            ImGui::BeginTooltip();
+            ImGui::Text("Date:   %s", buff);
+            ImGui::Text("Open:   $%.2f", open[idx]);
+            ImGui::Text("High:   $%.2f", high[idx]);
+            ImGui::Text("Low:    $%.2f", low[idx]);
+            ImGui::Text("Close:  $%.2f", close[idx]);
+            ImGui::Text("Volume: %llu", (unsigned long long)candles->volume[idx]);
+            // Same conditions as the panes: below them the buffers hold no values.
+            if (count > ma_window && (size_t)idx >= ma_warmup())
+                ImGui::Text("MA20:   $%.2f", c->ma[idx]);
+            if (count > macd_warmup() + 1 && (size_t)idx >= macd_warmup())
+                ImGui::Text("MACD:   %.3f / %.3f", c->macd[idx], c->macd_signal[idx]);
+            if ((size_t)idx >= rsi_warmup())
+                ImGui::Text("RSI14:  %.1f", c->rsi[idx]);
+            ImGui::EndTooltip();
+        }
+    }
+}
+
+static void plot_volume(const chart* c, const chart_frame* f) {
+    static const double half_width = 0.25f;
+
+    const lv_candles* candles = &c->candles;
+    setup_pane_ticks(f);
+    ImPlot::SetupAxisFormat(ImAxis_Y1, volume_formatter);
+    const chart_view v = pane_view(f, candles->size);
+
+    ImDrawList* draw_list = ImPlot::GetPlotDrawList();
+    if (ImPlot::BeginItem("Volume")) {
+        ImPlot::GetCurrentItem()->Color = IM_COL32(64,64,64,255);
+        if (ImPlot::FitThisFrame()) {
+            for (int i = v.first; i < v.last; ++i) {
+                ImPlot::FitPoint(ImPlotPoint(i, 0.0));
+                ImPlot::FitPoint(ImPlotPoint(i, (double)candles->volume[i]));
+            }
+        }
+        const ImU32 bull = ImGui::GetColorU32(bull_col);
+        const ImU32 bear = ImGui::GetColorU32(bear_col);
+        for (int i = v.first; i < v.last; ++i) {
+            ImVec2 top = ImPlot::PlotToPixels(i - half_width, (double)candles->volume[i]);
+            ImVec2 bot = ImPlot::PlotToPixels(i + half_width, 0.0);
+            draw_list->AddRectFilled(top, bot, candles->open[i] > candles->close[i] ? bear : bull);
+        }
+        ImPlot::EndItem();
+    }
+}
+
+static void plot_macd(const chart* c, const chart_frame* f) {
+    setup_pane_ticks(f);
+    const chart_view v = pane_view(f, c->candles.size);
+    int first = ImMax(v.first, (int)macd_warmup());
+    if (c->candles.size <= macd_warmup() + 1 || v.last <= first)
+        return;
+    const int warmup = (int)macd_warmup();
+    const int n = (int)c->candles.size - warmup;
+    ImPlot::PlotBars("Hist", c->macd_hist + first, v.last - first, 0.5, (double)first);
+    ImPlot::SetNextLineLOD(c->version);
+    ImPlot::PlotLine("MACD", c->macd + warmup, n, 1.0, (double)warmup, ImPlotLineFlags_Downsample);
+    ImPlot::SetNextLineLOD(c->version);
+    ImPlot::PlotLine("Signal", c->macd_signal + warmup, n, 1.0, (double)warmup, ImPlotLineFlags_Downsample);
+}
+
+static void plot_rsi(const chart* c, const chart_frame* f) {
+    static const double bands[] = { 30.0, 70.0 };
+    setup_pane_ticks(f);
+    ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 100.0, ImPlotCond_Always);
+    ImPlot::SetNextLineStyle(ImVec4(0.5f, 0.5f, 0.5f, 0.6f));
+    ImPlot::PlotInfLines("##bands", bands, 2, ImPlotInfLinesFlags_Horizontal);
+    if (c->candles.size <= rsi_period)
+        return;
+    const int warmup = (int)rsi_warmup();
+    ImPlot::SetNextLineLOD(c->version);
+    ImPlot::PlotLine("RSI14", c->rsi + warmup, (int)c->candles.size - warmup, 1.0, (double)warmup, ImPlotLineFlags_Downsample);
+}
+
+// Price, volume, MACD and RSI panes with linked x axes. Only the bottom pane
+// shows date labels.
+static void plot_chart(const char* label_id, chart* c, bool tooltip) {
+    static float row_ratios[] = { 4.0f, 1.0f, 1.2f, 1.2f };
+    static const ImPlotAxisFlags x_inner = ImPlotAxisFlags_NoTickLabels;
+    static const ImPlotAxisFlags y_fit = ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit;
+    if (c->candles.size == 0) {
+        ImGui::TextDisabled("%s: %s", c->symbol, c->status == chart_loading ? "loading" : "no data");
+        return;
+    }
+    chart_frame frame = {};
+    if (ImPlot::BeginSubplots(label_id, 4, 1, ImVec2(-1,-1), ImPlotSubplotFlags_LinkAllX | ImPlotSubplotFlags_NoTitle, row_ratios)) {
+        if (ImPlot::BeginPlot("##Price")) {
+            ImPlot::SetupAxes(nullptr, nullptr, x_inner, y_fit);
+            {
+                PROFILE_SCOPE(profile_candles);
+                plot_candles(label_id, c, &frame, tooltip);
+            }
+            ImPlot::EndPlot();
+        }
+        if (ImPlot::BeginPlot("##Volume")) {
+            ImPlot::SetupAxes(nullptr, nullptr, x_inner, y_fit);
+            plot_volume(c, &frame);
+            ImPlot::EndPlot();
+        }
+        if (ImPlot::BeginPlot("##MACD")) {
+            ImPlot::SetupAxes(nullptr, nullptr, x_inner, y_fit);
+            plot_macd(c, &frame);
+            ImPlot::EndPlot();
+        }
+        if (ImPlot::BeginPlot("##RSI")) {
+            ImPlot::SetupAxes(nullptr, nullptr, 0, ImPlotAxisFlags_Lock);
+            plot_rsi(c, &frame);
+            ImPlot::EndPlot();
+        }
+        ImPlot::EndSubplots();
+    }
+}
+
+static void draw_tile(chart* c, ImVec2 p0, ImVec2 p1, bool hovered) {
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    const ImGuiStyle& style = ImGui::GetStyle();
+    draw_list->AddRectFilled(p0, p1, ImGui::GetColorU32(hovered ? ImGuiCol_FrameBgHovered : ImGuiCol_FrameBg), style.FrameRounding);
+    ImVec2 text_pos(p0.x + style.FramePadding.x, p0.y + style.FramePadding.y);
+    draw_list->AddText(text_pos, ImGui::GetColorU32(ImGuiCol_Text), c->symbol);
+    if (c->status != chart_ready) {
+        draw_list->AddText(ImVec2(text_pos.x, text_pos.y + ImGui::GetTextLineHeight()), ImGui::GetColorU32(ImGuiCol_TextDisabled),
+                           c->status == chart_loading ? "loading" : "failed");
+        return;
+    }
+
+    const lv_candles* k = &c->candles;
+    double first = k->close[0], last = k->close[k->size - 1];
+    bool up = last >= first;
+    ImU32 col = ImGui::GetColorU32(up ? bull_col : bear_col);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.2f %+.2f%%", last, first != 0.0 ? (last / first - 1.0) * 100.0 : 0.0);
+    float buf_w = ImGui::CalcTextSize(buf).x;
+    draw_list->AddText(ImVec2(p1.x - style.FramePadding.x - buf_w, text_pos.y), col, buf);
+
+    // sparkline: one min/max bar per pixel column
+    float x0 = p0.x + style.FramePadding.x;
+    float x1 = p1.x - style.FramePadding.x;
+    float y0 = text_pos.y + ImGui::GetTextLineHeightWithSpacing();
+    float y1 = p1.y - style.FramePadding.y;
+    chart_update_sparkline(c, (int)(x1 - x0));
+    if (c->spark_cols == 0)
+        return;
+    float lo = c->spark_lo[0], hi = c->spark_hi[0];
+    for (int i = 1; i < c->spark_cols; i++) {
+        lo = ImMin(lo, c->spark_lo[i]);
+        hi = ImMax(hi, c->spark_hi[i]);
+    }
+    float scale = hi > lo ? (y1 - y0) / (hi - lo) : 0.0f;
+    float step  = (x1 - x0) / (float)c->spark_cols;
+    for (int i = 0; i < c->spark_cols; i++) {
+        float x = ImFloor(x0 + step * (float)i);
+        float top = y1 - (c->spark_hi[i] - lo) * scale;
+        float bot = y1 - (c->spark_lo[i] - lo) * scale;
+        draw_list->AddRectFilled(ImVec2(x, top), ImVec2(x + ImMax(1.0f, ImFloor(step)), ImMax(bot, top + 1.0f)), col);
+    }
+}
+
+// Grid of sparkline tiles. Only rows intersecting the scroll region are
+// submitted (ImGuiListClipper), and each tile draws from its cached columns,
+// so the cost per frame is bounded by what fits on screen. Clicking a tile
+// makes it the active chart.
+static void show_dashboard(chart* charts, size_t count, size_t* active) {
+    const ImGuiStyle& style = ImGui::GetStyle();
+    const ImVec2 tile(ImGui::GetFontSize() * 14.0f, ImGui::GetFontSize() * 6.0f);
+    if (!ImGui::BeginChild("##dashboard")) {
+        ImGui::EndChild();
+        return;
+    }
+    float avail = ImGui::GetContentRegionAvail().x;
+    int cols = ImMax(1, (int)((avail + style.ItemSpacing.x) / (tile.x + style.ItemSpacing.x)));
+    int rows = (int)((count + cols - 1) / cols);
+    ImGuiListClipper clipper;
+    clipper.Begin(rows, tile.y + style.ItemSpacing.y);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            for (int col = 0; col < cols; col++) {
+                size_t i = (size_t)row * cols + col;
+                if (i >= count)
+                    break;
+                if (col > 0)
+                    ImGui::SameLine();
+                ImGui::PushID((int)i);
+                if (ImGui::InvisibleButton("##tile", tile))
+                    *active = i;
+                draw_tile(&charts[i], ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImGui::IsItemHovered());
+                ImGui::PopID();
+            }
+        }
+    }
+    ImGui::EndChild();
+}
+
+// Historical replay. The active chart's series is copied onto a tape, the
+// first `start` bars are preloaded and the rest are appended to a chart of its
+// own at `speed` bars per second, through chart_extend like live bars. The
+// frame then costs the new bars plus what is on screen, so with follow on it
+// stays flat however much history has been played.
+struct chart_replay {
+    lv_candles   tape;
+    chart        view;
+    bool         loaded;
+    const chart* source;
+    unsigned     generation;    // source generation the tape was copied from
+    int          start;
+    size_t       next;          // next tape bar to append
+    float        speed;         // bars per second
+    double       due;           // fraction of a bar owed by the clock
+    bool         playing;
+    bool         follow;
+    int          window;        // bars in view while following
+};
+
+static void replay_free(chart_replay* r) {
+    if (!r->loaded)
+        return;
+    lv_candles_free(&r->tape);
+    chart_free(&r->view);
+    r->loaded  = false;
+    r->playing = false;
+}
+
+static void replay_load(chart_replay* r, const chart* c) {
+    replay_free(r);
+    const lv_candles* src = &c->candles;
+    const size_t n = src->size;
+    lv_candles_init(&r->tape, n);
+    memcpy(r->tape.timestamp, src->timestamp, sizeof(time_t) * n);
+    memcpy(r->tape.open, src->open, sizeof(double) * n);
+    memcpy(r->tape.high, src->high, sizeof(double) * n);
+    memcpy(r->tape.low, src->low, sizeof(double) * n);
+    memcpy(r->tape.close, src->close, sizeof(double) * n);
+    memcpy(r->tape.volume, src->volume, sizeof(uint64_t) * n);
+    r->tape.size = n;
+    chart_init(&r->view, c->symbol, n);
+    r->start = ImClamp(r->start, 1, (int)n);
+    for (size_t i = 0; i < (size_t)r->start; i++)
+        lv_candles_append(&r->view.candles, r->tape.timestamp[i], r->tape.open[i], r->tape.high[i], r->tape.low[i], r->tape.close[i], r->tape.volume[i]);
+    chart_update(&r->view);
+    r->view.status = chart_ready;
+    r->view.refit  = true;
+    r->loaded     = true;
+    r->source     = c;
+    r->generation = c->generation;
+    r->next       = (size_t)r->start;
+    r->due        = 0.0;
+}
+
+// Appends up to `bars` tape bars and extends the chart once for all of them.
+static void replay_step(chart_replay* r, size_t bars) {
+    const size_t from = r->view.candles.size;
+    const lv_candles* t = &r->tape;
+    for (; bars > 0 && r->next < t->size; bars--, r->next++) {
+        const size_t i = r->next;
+        if (lv_candles_append(&r->view.candles, t->timestamp[i], t->open[i], t->high[i], t->low[i], t->close[i], t->volume[i]) != 0)
+            break;
+    }
+    if (r->view.candles.size > from)
+        chart_extend(&r->view, from);
+    if (r->next >= t->size)
+        r->playing = false;
+}
+
+// Called once per frame with the frame time, whichever tab is showing.
+static void replay_advance(chart_replay* r, float dt) {
+    if (!r->loaded || !r->playing)
+        return;
+    r->due += (double)dt * r->speed;
+    const size_t bars = (size_t)r->due;
+    r->due -= (double)bars;
+    replay_step(r, bars);
+}
+
+static void show_replay(chart_replay* r, const chart* c, bool tooltip) {
+    if (!r->loaded && c->status == chart_ready)
+        replay_load(r, c);
+    ImGui::PushItemWidth(ImGui::GetFontSize() * 8.0f);
+    ImGui::DragInt("Start", &r->start, 1.0f, 1, ImMax(1, (int)c->candles.size));
+    ImGui::SameLine();
+    if (ImGui::Button("Load") && c->status == chart_ready)
+        replay_load(r, c);
+    if (!r->loaded) {
+        ImGui::PopItemWidth();
+        ImGui::TextDisabled("%s: %s", c->symbol, c->status == chart_loading ? "loading" : "no data");
+        return;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(r->playing ? "Pause" : "Play") && r->next < r->tape.size) {
+        r->playing = !r->playing;
+        r->due = 0.0;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Step"))
+        replay_step(r, 1);
+    ImGui::SameLine();
+    ImGui::SliderFloat("Speed", &r->speed, 1.0f, 1000.0f, "%.0f bars/s", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow", &r->follow);
+    if (r->follow) {
+        ImGui::SameLine();
+        ImGui::DragInt("Window", &r->window, 1.0f, 20, 5000);
+        r->window = ImClamp(r->window, 20, 5000);
+    }
+    ImGui::PopItemWidth();
+    r->view.follow = r->follow ? r->window : 0;
+
+    char buff[32];
+    const lv_candles* v = &r->view.candles;
+    struct tm* tm_info = localtime(&v->timestamp[v->size - 1]);
+    strftime(buff, sizeof(buff), "%Y-%m-%d %H:%M", tm_info);
+    ImGui::Text("%s  %zu / %zu bars  %s%s", r->view.symbol, v->size, r->tape.size, buff,
+                r->source == c && r->generation != c->generation ? "  (source reloaded since)" : "");
+    plot_chart("##replay", &r->view, tooltip);
+}
+
+// Moving-average crossover on the active chart. The whole backtest reruns when
+// a parameter or the candles change; it is a few linear passes, cheap enough
+// to follow a slider drag on long series.
+struct backtest_view {
+    int               fast;
+    int               slow;
+    bool              long_short;   // short below the slow average instead of going flat
+    int               fill;         // lv_fill
+    float             commission_bps;
+    float             slippage_bps;
+    const chart*      source;       // chart and generation the results belong to
+    unsigned          generation;
+    size_t            cap;
+    double*           fast_ma;
+    double*           slow_ma;
+    double*           position;
+    double*           equity;
+    double*           drawdown;
+    double*           benchmark;    // buy and hold, growth of 1
+    lv_backtest_stats stats;
+    int               result;
+    double            elapsed_ms;
+    ImU64             version;      // plot version of equity and benchmark, new per run
+};
+
+// Settings the Backtest tab opens with: 10/30 crossover, long only, next-open fills.
+static const backtest_view backtest_view_defaults = { 10, 30, false, LV_FILL_NEXT_OPEN, 3.0f, 2.0f };
+
+static int percent_formatter(double value, char* buff, int size, void*) {
+    return snprintf(buff, size, "%.0f%%", value * 100.0);
+}
+
+static void backtest_view_free(backtest_view* v) {
+    free(v->fast_ma);
+    free(v->slow_ma);
+    free(v->position);
+    free(v->equity);
+    free(v->drawdown);
+    free(v->benchmark);
+}
+
+static void backtest_view_run(backtest_view* v, const chart* c) {
+    const lv_candles* candles = &c->candles;
+    const size_t n = candles->size;
+    if (n > v->cap) {
+        backtest_view_free(v);
+        v->fast_ma   = (double*)malloc(sizeof(double) * n);
+        v->slow_ma   = (double*)malloc(sizeof(double) * n);
+        v->position  = (double*)malloc(sizeof(double) * n);
+        v->equity    = (double*)malloc(sizeof(double) * n);
+        v->drawdown  = (double*)malloc(sizeof(double) * n);
+        v->benchmark = (double*)malloc(sizeof(double) * n);
+        v->cap = n;
+    }
+    v->source = c;
+    v->generation = c->generation;
+    v->result = -1;
+    if (n <= (size_t)v->slow)
+        return;
+
+    uint64_t t0 = SDL_GetPerformanceCounter();
+    lv_indicator_ma((size_t)v->fast, n, candles->close, v->fast_ma);
+    lv_indicator_ma((size_t)v->slow, n, candles->close, v->slow_ma);
+    const double below = v->long_short ? -1.0 : 0.0;
+    const size_t warmup = (size_t)v->slow - 1;
+    for (size_t i = 0; i < n; i++)
+        v->position[i] = i < warmup ? 0.0 : v->fast_ma[i] > v->slow_ma[i] ? 1.0 : below;
+    lv_backtest_config config = { (lv_fill)v->fill, v->commission_bps * 1e-4, v->slippage_bps * 1e-4, 0.0 };
+    v->result = lv_backtest_vector(candles, v->position, &config, nullptr, v->equity, v->drawdown, &v->stats);
+    v->elapsed_ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    for (size_t i = 0; i < n; i++)
+        v->benchmark[i] = candles->close[i] / candles->close[0];
+    v->version = next_plot_version();
+}
+
+static void show_backtest(backtest_view* v, const chart* c) {
+    static const char* fill_names[] = { "Close", "Next Open" };
+    bool changed = v->source != c || v->generation != c->generation;
+    ImGui::PushItemWidth(ImGui::GetFontSize() * 8.0f);
+    changed |= ImGui::SliderInt("Fast", &v->fast, 2, 200);
+    ImGui::SameLine();
+    changed |= ImGui::SliderInt("Slow", &v->slow, 3, 500);
+    ImGui::SameLine();
+    changed |= ImGui::Combo("Fill", &v->fill, fill_names, IM_ARRAYSIZE(fill_names));
+    ImGui::SameLine();
+    changed |= ImGui::SliderFloat("Commission (bps)", &v->commission_bps, 0.0f, 50.0f, "%.1f");
+    ImGui::SameLine();
+    changed |= ImGui::SliderFloat("Slippage (bps)", &v->slippage_bps, 0.0f, 50.0f, "%.1f");
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("Long/Short", &v->long_short);
+    ImGui::PopItemWidth();
+    v->slow = ImMax(v->slow, v->fast + 1);
+    if (changed && c->status == chart_ready)
+        backtest_view_run(v, c);
+
+    if (c->status != chart_ready || v->result != 0) {
+        ImGui::TextDisabled("%s: %s", c->symbol, c->status == chart_loading ? "loading" :
+                            c->status == chart_failed ? "no data" : "not enough bars for the slow average");
+        return;
+    }
+    const lv_backtest_stats& s = v->stats;
+    ImGui::Text("%s  return %+.2f%%  CAGR %+.2f%%  max DD %.2f%%  Sharpe %.2f  turnover %.1fx/yr  trades %zu  (%.3f ms)",
+                c->symbol, s.total_return * 100.0, s.cagr * 100.0, s.max_drawdown * 100.0, s.sharpe, s.turnover, s.trades, v->elapsed_ms);
+
+    static float row_ratios[] = { 3.0f, 1.0f };
+    const int n = (int)c->candles.size;
+    chart_frame frame = {};
+    if (ImPlot::BeginSubplots("##backtest", 2, 1, ImVec2(-1,-1), ImPlotSubplotFlags_LinkAllX | ImPlotSubplotFlags_NoTitle, row_ratios)) {
+        if (ImPlot::BeginPlot("##Equity")) {
+            ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, -1, (double)n + 3, ImPlotCond_Once);
+            ImPlotPlot* plot = ImPlot::GetCurrentPlot();
+            ImPlotRange x_prev = plot->Axes[ImAxis_X1].Range;
+            float plot_px = plot->PlotRect.GetWidth() > 0 ? plot->PlotRect.GetWidth() : ImGui::GetContentRegionAvail().x;
+            chart_frame_ticks(&frame, c, x_prev.Min - x_prev.Size(), x_prev.Max + x_prev.Size(), plot_px * 3.0f);
+            setup_pane_ticks(&frame);
+            ImPlot::SetNextLineLOD(v->version);
+            ImPlot::PlotLine("Strategy", v->equity, n, 1.0, 0.0, ImPlotLineFlags_Downsample);
+            ImPlot::SetNextLineLOD(v->version);
+            ImPlot::PlotLine("Buy & Hold", v->benchmark, n, 1.0, 0.0, ImPlotLineFlags_Downsample);
+            ImPlot::EndPlot();
+        }
+        if (ImPlot::BeginPlot("##Drawdown")) {
+            ImPlot::SetupAxes(nullptr, nullptr, 0, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit | ImPlotAxisFlags_Invert);
+            ImPlot::SetupAxisFormat(ImAxis_Y1, percent_formatter);
+            setup_pane_ticks(&frame);
+            ImPlot::SetNextFillStyle(bear_col, 0.5f);
+            ImPlot::PlotShaded("Drawdown", v->drawdown, n, 0.0, 1.0, 0.0);
+            ImPlot::EndPlot();
+        }
+        ImPlot::EndSubplots();
+    }
+}
+
+// Bootstrap confidence intervals for the Backtest tab's strategy: resampled
+// blocks of its per-bar returns, or its trades drawn independently. Runs on
+// demand; lv_bootstrap spreads the paths over all cores.
+struct backtest_montecarlo {
+    int                  paths;
+    int                  block;         // bars per draw
+    int                  seed;
+    bool                 trades;        // resample whole trades instead of bars
+    const chart*         source;        // chart and generation the results belong to
+    unsigned             generation;
+    size_t               samples;       // returns or trades resampled
+    lv_bootstrap_result  result;
+    int                  status;        // of the last run, -1 before the first
+    double               elapsed_ms;
+};
+
+static const double montecarlo_quantiles[] = { 0.05, 0.25, 0.5, 0.75, 0.95 };
+
+static void montecarlo_free(backtest_montecarlo* m) {
+    if (m->status == 0)
+        lv_bootstrap_free(&m->result);
+    m->status = -1;
+}
+
+static void montecarlo_run(backtest_montecarlo* m, backtest_view* v, const chart* c) {
+    montecarlo_free(m);
+    m->source     = c;
+    m->generation = c->generation;
+    if (v->source != c || v->generation != c->generation)
+        backtest_view_run(v, c);
+    if (v->result != 0)
+        return;
+    const lv_candles* candles = &c->candles;
+    const size_t n = candles->size;
+    uint64_t t0 = SDL_GetPerformanceCounter();
+    double* returns = (double*)malloc(sizeof(double) * n);
+    lv_backtest_config config = { (lv_fill)v->fill, v->commission_bps * 1e-4, v->slippage_bps * 1e-4, 0.0 };
+    lv_backtest_vector(candles, v->position, &config, returns, nullptr, nullptr, nullptr);
+    const double years = (double)(candles->timestamp[n - 1] - candles->timestamp[0]) / (365.25 * 86400.0);
+    m->samples = n;
+    if (m->trades) {
+        // exposure through bar i was decided on an earlier close
+        double* held = (double*)malloc(sizeof(double) * n);
+        const size_t lag = v->fill == LV_FILL_CLOSE ? 1 : 2;
+        for (size_t i = 0; i < n; i++)
+            held[i] = i < lag ? 0.0 : v->position[i - lag];
+        m->samples = lv_trade_returns(n, returns, held, returns);
+        free(held);
+    }
+    const double per_year = years > 0.0 ? (double)m->samples / years : 0.0;
+    lv_bootstrap_config bootstrap = {
+        (size_t)m->paths, 0, m->trades ? 1 : (size_t)m->block, per_year, (uint64_t)m->seed,
+        montecarlo_quantiles, IM_ARRAYSIZE(montecarlo_quantiles), 0
+    };
+    m->status = m->samples > 0 ? lv_bootstrap(m->samples, returns, &bootstrap, &m->result) : -1;
+    free(returns);
+    m->elapsed_ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void show_montecarlo(backtest_montecarlo* m, backtest_view* v, const chart* c) {
+    ImGui::PushItemWidth(ImGui::GetFontSize() * 8.0f);
+    ImGui::DragInt("Paths", &m->paths, 100.0f, 100, 1000000);
+    ImGui::SameLine();
+    ImGui::BeginDisabled(m->trades);
+    ImGui::SliderInt("Block (bars)", &m->block, 1, 250);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::InputInt("Seed", &m->seed);
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    ImGui::Checkbox("Resample Trades", &m->trades);
+    m->paths = ImMax(m->paths, 100);
+    m->block = ImMax(m->block, 1);
+    ImGui::SameLine();
+    if (ImGui::Button("Run Bootstrap") && c->status == chart_ready)
+        montecarlo_run(m, v, c);
+
+    const bool current = m->source == c && m->generation == c->generation;
+    if (!current || m->status != 0) {
+        ImGui::TextDisabled("%s: %s", c->symbol, c->status != chart_ready ? "no data" :
+                            current ? "no returns to resample" : "resamples the strategy of the Backtest tab");
+        return;
+    }
+    const lv_bootstrap_result& r = m->result;
+    ImGui::Text("%s  %zu paths of %zu %s  P(loss) %.1f%%  (%.1f ms)", c->symbol, r.paths, r.length,
+                m->trades ? "trades" : "bars", r.loss_probability * 100.0, m->elapsed_ms);
+    if (ImGui::BeginTable("##quantiles", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Quantile");
+        ImGui::TableSetupColumn("Total Return");
+        ImGui::TableSetupColumn("CAGR");
+        ImGui::TableSetupColumn("Max Drawdown");
+        ImGui::TableHeadersRow();
+        for (int k = 0; k < IM_ARRAYSIZE(montecarlo_quantiles); k++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%.0f%%", montecarlo_quantiles[k] * 100.0);
+            ImGui::TableNextColumn(); ImGui::Text("%+.2f%%", r.total_return[k] * 100.0);
+            ImGui::TableNextColumn(); ImGui::Text("%+.2f%%", r.cagr[k] * 100.0);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f%%", r.max_drawdown[k] * 100.0);
+        }
+        ImGui::EndTable();
+    }
+}
+
+// Grid search of the crossover windows over every loaded symbol, using the
+// fill and cost settings of the Backtest tab. Jobs read the charts' candles
+// and one close prefix sum per chart in place, so a chart in a running sweep
+// must not be replaced (sweep_guard).
+struct backtest_sweep {
+    lv_sweep*          running;
+    lv_sweep_table     table;
+    bool               has_table;
+    const chart**      charts;      // ready charts when the sweep started, one symbol each
+    double**           prefix;      // sums of close, sz + 1 entries per chart
+    size_t             count;
+    int                fast_range[2];
+    int                slow_range[2];
+    int                resolution;  // grid cells per axis
+    int                fast_lo, fast_step, cols;
+    int                slow_lo, slow_step, rows;
+    lv_backtest_config config;
+    double             below;       // position under the slow average
+    int                metric;
+    float*             heat;        // rows * cols, highest slow window first
+    uint64_t           started;
+    double             elapsed_ms;
+};
+
+enum sweep_metric { sweep_sharpe, sweep_return, sweep_cagr, sweep_drawdown, sweep_turnover };
+static const char* sweep_metric_names[] = { "Sharpe", "Total Return", "CAGR", "Max Drawdown", "Turnover" };
+
+static const double* sweep_column(const lv_sweep_table* t, int metric) {
+    switch (metric) {
+    case sweep_return:   return t->total_return;
+    case sweep_cagr:     return t->cagr;
+    case sweep_drawdown: return t->max_drawdown;
+    case sweep_turnover: return t->turnover;
+    default:             return t->sharpe;
+    }
+}
+
+// About resolution evenly spaced windows covering range, at least one bar apart.
+static void crossover_grid(const int range[2], int resolution, int* lo, int* step, int* count) {
+    *lo    = range[0];
+    *step  = ImMax(1, (range[1] - range[0]) / ImMax(1, resolution - 1));
+    *count = (range[1] - range[0]) / *step + 1;
+}
+
+// Crossover positions for bars [first, last) from a prefix sum of close: fast
+// average above slow, compared without dividing; flat until both exist.
+static void crossover_positions(const double* sum, size_t fast, size_t slow, double below, size_t first, size_t last, double* position) {
+    const double fs = (double)fast, ss = (double)slow;
+    size_t i = first;
+    for (; i < last && i + 1 < slow; i++)
+        position[i] = 0.0;
+    for (; i < last; i++)
+        position[i] = (sum[i + 1] - sum[i + 1 - fast]) * ss > (sum[i + 1] - sum[i + 1 - slow]) * fs ? 1.0 : below;
+}
+
+static int sweep_job(void* user, size_t param, size_t symbol, double* position, lv_backtest_stats* stats) {
+    const backtest_sweep* s = (const backtest_sweep*)user;
+    const size_t fast = (size_t)(s->fast_lo + (int)(param % s->cols) * s->fast_step);
+    const size_t slow = (size_t)(s->slow_lo + (int)(param / s->cols) * s->slow_step);
+    const lv_candles* candles = &s->charts[symbol]->candles;
+    const size_t n = candles->size;
+    if (fast >= slow || slow >= n)
+        return -1;
+    crossover_positions(s->prefix[symbol], fast, slow, s->below, 0, n, position);
+    return lv_backtest_vector(candles, position, &s->config, nullptr, nullptr, nullptr, stats);
+}
+
+static void sweep_release(backtest_sweep* s) {
+    if (s->running) {
+        lv_sweep_cancel(s->running);
+        lv_sweep_wait(s->running);
+        s->running = nullptr;
+    }
+    if (s->has_table)
+        lv_sweep_table_free(&s->table);
+    s->has_table = false;
+    for (size_t i = 0; i < s->count; i++)
+        free(s->prefix[i]);
+    free(s->prefix);
+    free(s->charts);
+    free(s->heat);
+    s->prefix = nullptr;
+    s->charts = nullptr;
+    s->heat   = nullptr;
+    s->count  = 0;
+}
+
+// Called before a chart's candles are swapped out.
+static void sweep_guard(backtest_sweep* s, const chart* c) {
+    if (!s->running)
+        return;
+    for (size_t i = 0; i < s->count; i++) {
+        if (s->charts[i] == c) {
+            lv_sweep_cancel(s->running);
+            lv_sweep_wait(s->running);
+            s->running = nullptr;
+            return;
+        }
+    }
+}
+
+static void sweep_start(backtest_sweep* s, const backtest_view* v, chart* charts, size_t count) {
+    sweep_release(s);
+    s->charts = (const chart**)malloc(sizeof(const chart*) * count);
+    s->prefix = (double**)malloc(sizeof(double*) * count);
+    size_t longest = 0;
+    for (size_t i = 0; i < count; i++) {
+        const lv_candles* candles = &charts[i].candles;
+        if (charts[i].status != chart_ready || candles->size == 0)
+            continue;
+        s->charts[s->count] = &charts[i];
+        s->prefix[s->count] = (double*)malloc(sizeof(double) * (candles->size + 1));
+        lv_prefix_sum(candles->size, candles->close, s->prefix[s->count]);
+        longest = ImMax(longest, candles->size);
+        s->count++;
+    }
+    crossover_grid(s->fast_range, s->resolution, &s->fast_lo, &s->fast_step, &s->cols);
+    crossover_grid(s->slow_range, s->resolution, &s->slow_lo, &s->slow_step, &s->rows);
+    s->config    = { (lv_fill)v->fill, v->commission_bps * 1e-4, v->slippage_bps * 1e-4, 0.0 };
+    s->below     = v->long_short ? -1.0 : 0.0;
+    s->heat      = (float*)malloc(sizeof(float) * s->rows * s->cols);
+    if (s->count == 0 || lv_sweep_table_init(&s->table, (size_t)(s->rows * s->cols), s->count) != 0)
+        return;
+    s->has_table = true;
+    lv_sweep_config config = { sweep_job, s, longest, 0 };
+    s->started = SDL_GetPerformanceCounter();
+    s->running = lv_sweep_start(&config, &s->table);
+}
+
+// Mean of the finished symbols per cell. Returns false until any cell has a value.
+static bool sweep_heat(backtest_sweep* s, float* lo, float* hi) {
+    const double* column = sweep_column(&s->table, s->metric);
+    bool any = false;
+    for (int r = 0; r < s->rows; r++) {
+        for (int col = 0; col < s->cols; col++) {
+            const size_t param = (size_t)(r * s->cols + col);
+            double sum = 0.0;
+            int n = 0;
+            for (size_t k = 0; k < s->count; k++) {
+                const size_t row = param * s->count + k;
+                if (lv_sweep_row_done(&s->table, row) && !ImNan(column[row])) {
+                    sum += column[row];
+                    n++;
+                }
+            }
+            float value = n ? (float)(sum / n) : NAN;
+            s->heat[(s->rows - 1 - r) * s->cols + col] = value;
+            if (n && (!any || value < *lo)) *lo = value;
+            if (n && (!any || value > *hi)) *hi = value;
+            any |= n > 0;
+        }
+    }
+    // Unfinished and inapplicable cells take the bottom of the scale.
+    for (int i = 0; any && i < s->rows * s->cols; i++)
+        if (ImNan(s->heat[i]))
+            s->heat[i] = *lo;
+    return any;
+}
+
+// Clicking a cell loads its windows into the Backtest tab.
+static void show_sweep(backtest_sweep* s, backtest_view* v, chart* charts, size_t count) {
+    ImGui::PushItemWidth(ImGui::GetFontSize() * 10.0f);
+    ImGui::DragIntRange2("Fast", &s->fast_range[0], &s->fast_range[1], 1.0f, 2, 400);
+    ImGui::SameLine();
+    ImGui::DragIntRange2("Slow", &s->slow_range[0], &s->slow_range[1], 1.0f, 3, 1000);
+    ImGui::SameLine();
+    ImGui::SliderInt("Grid", &s->resolution, 4, 128);
+    ImGui::SameLine();
+    ImGui::Combo("Metric", &s->metric, sweep_metric_names, IM_ARRAYSIZE(sweep_metric_names));
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (s->running) {
+        // Only jobs already running are waited for; the rest are skipped.
+        if (ImGui::Button("Cancel")) {
+            lv_sweep_cancel(s->running);
+            lv_sweep_wait(s->running);
+            s->running = nullptr;
+        }
+    } else if (ImGui::Button("Run Sweep")) {
+        sweep_start(s, v, charts, count);
+    }
+
+    if (s->running && lv_sweep_progress(s->running) == s->table.params * s->table.symbols) {
+        lv_sweep_wait(s->running);
+        s->running = nullptr;
+    }
+    if (s->running)
+        s->elapsed_ms = (double)(SDL_GetPerformanceCounter() - s->started) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    if (!s->has_table) {
+        ImGui::TextDisabled(s->heat ? "no loaded symbols" : "fast x slow crossover grid over every loaded symbol");
+        return;
+    }
+    const size_t jobs = s->table.params * s->table.symbols;
+    size_t done = 0;
+    for (size_t i = 0; i < jobs; i++)
+        done += lv_sweep_row_done(&s->table, i);
+    ImGui::Text("%zu / %zu jobs  %d x %d windows  %zu symbols  %.1f ms%s", done, jobs, s->cols, s->rows, s->count, s->elapsed_ms,
+                s->running ? "" : done < jobs ? "  cancelled" : "  done");
+
+    float lo = 0.0f, hi = 1.0f;
+    if (!sweep_heat(s, &lo, &hi))
+        return;
+    if (hi <= lo)
+        hi = lo + 1.0f;
+    const float scale_w = ImGui::GetFontSize() * 5.0f;
+    const double fx = 0.5 * s->fast_step, sy = 0.5 * s->slow_step;
+    const ImPlotPoint bmin(s->fast_lo - fx, s->slow_lo - sy);
+    const ImPlotPoint bmax(s->fast_lo + (s->cols - 1) * s->fast_step + fx, s->slow_lo + (s->rows - 1) * s->slow_step + sy);
+    ImPlot::PushColormap(ImPlotColormap_Viridis);
+    if (ImPlot::BeginPlot("##sweep", ImVec2(ImGui::GetContentRegionAvail().x - scale_w - ImGui::GetStyle().ItemSpacing.x, -1), ImPlotFlags_NoLegend)) {
+        ImPlot::SetupAxes("fast window", "slow window", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        ImPlot::PlotHeatmap("##heat", s->heat, s->rows, s->cols, lo, hi, nullptr, bmin, bmax);
+        if (ImPlot::IsPlotHovered()) {
+            ImPlotPoint m = ImPlot::GetPlotMousePos();
+            int col = (int)ImFloor((m.x - bmin.x) / s->fast_step), row = (int)ImFloor((m.y - bmin.y) / s->slow_step);
+            if (col >= 0 && col < s->cols && row >= 0 && row < s->rows) {
+                const int fast = s->fast_lo + col * s->fast_step, slow = s->slow_lo + row * s->slow_step;
+                ImGui::SetTooltip("fast %d  slow %d\n%s %.3f", fast, slow, sweep_metric_names[s->metric], s->heat[(s->rows - 1 - row) * s->cols + col]);
+                if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && fast < slow) {
+                    v->fast   = fast;
+                    v->slow   = slow;
+                    v->source = nullptr; // rerun with the picked windows
+                }
+            }
+        }
+        ImPlot::EndPlot();
+    }
+    ImGui::SameLine();
+    ImPlot::ColormapScale("##scale", lo, hi, ImVec2(scale_w, -1));
+    ImPlot::PopColormap();
+}
+
+// Cross-sectional momentum over every loaded symbol, on the union of their
+// time axes: each rebalance holds the strongest symbols over the lookback in
+// equal weights. The benchmark holds every symbol with a price equally.
+// Runs on demand; the charts are only read during the run.
+struct backtest_portfolio {
+    int                lookback;     // steps of the union axis
+    int                top;          // symbols held
+    int                rebalance;    // steps between rebalances
+    size_t             symbols;
+    size_t             size;
+    double*            time;         // union axis in seconds, for the plot
+    double*            equity;
+    double*            benchmark;
+    lv_portfolio_stats stats;
+    lv_portfolio_stats benchmark_stats;
+    double*            score;        // per symbol, during a run
+    int*               order;
+    int                status;       // of the last run, -1 before the first
+    double             elapsed_ms;
+    ImU64              version;      // plot version of both curves, new per run
+};
+
+static void portfolio_momentum(void* user, const lv_timeline* timeline, size_t t, const double* price, double* weight) {
+    backtest_portfolio* p = (backtest_portfolio*)user;
+    const size_t count = timeline->count;
+    const uint32_t* past = t >= (size_t)p->lookback ? timeline->index + (t - p->lookback) * count : nullptr;
+    int ranked = 0;
+    for (size_t s = 0; s < count; s++) {
+        weight[s] = 0.0;
+        if (past && past[s] != LV_TIMELINE_NONE && price[s] > 0.0) {
+            p->score[s] = price[s] / timeline->series[s].close[past[s]];
+            p->order[ranked++] = (int)s;
+        }
+    }
+    const int held = ImMin(p->top, ranked);
+    if (held == 0)
+        return;
+    const double* score = p->score;
+    std::nth_element(p->order, p->order + held - 1, p->order + ranked, [score](int a, int b) { return score[a] > score[b]; });
+    for (int k = 0; k < held; k++)
+        weight[p->order[k]] = 1.0 / held;
+}
+
+static void portfolio_equal(void*, const lv_timeline* timeline, size_t, const double* price, double* weight) {
+    size_t live = 0;
+    for (size_t s = 0; s < timeline->count; s++)
+        live += price[s] > 0.0;
+    for (size_t s = 0; s < timeline->count; s++)
+        weight[s] = price[s] > 0.0 ? 1.0 / live : 0.0;
+}
+
+static void portfolio_free(backtest_portfolio* p) {
+    free(p->time);
+    free(p->equity);
+    free(p->benchmark);
+    p->time      = nullptr;
+    p->equity    = nullptr;
+    p->benchmark = nullptr;
+    p->status    = -1;
+}
+
+static void portfolio_run(backtest_portfolio* p, const backtest_view* v, const chart* charts, size_t count) {
+    portfolio_free(p);
+    uint64_t t0 = SDL_GetPerformanceCounter();
+    lv_candles* series = (lv_candles*)malloc(sizeof(lv_candles) * count);
+    p->symbols = 0;
+    for (size_t i = 0; i < count; i++)
+        if (charts[i].status == chart_ready && charts[i].candles.size > 0)
+            series[p->symbols++] = charts[i].candles; // shallow, the columns stay with the chart
+    lv_timeline timeline;
+    if (p->symbols == 0 || lv_timeline_init(&timeline, series, p->symbols) != 0) {
+        free(series);
+        return;
+    }
+    const size_t n = timeline.size;
+    p->size      = n;
+    p->time      = (double*)malloc(sizeof(double) * n);
+    p->equity    = (double*)malloc(sizeof(double) * n);
+    p->benchmark = (double*)malloc(sizeof(double) * n);
+    p->score     = (double*)malloc(sizeof(double) * p->symbols);
+    p->order     = (int*)malloc(sizeof(int) * p->symbols);
+    for (size_t t = 0; t < n; t++)
+        p->time[t] = (double)timeline.time[t];
+    lv_portfolio_config config = { portfolio_momentum, p, (size_t)p->rebalance, v->commission_bps * 1e-4, v->slippage_bps * 1e-4, 0.0 };
+    p->status = lv_portfolio_run(&timeline, &config, p->equity, &p->stats);
+    config.weights = portfolio_equal;
+    if (p->status == 0)
+        p->status = lv_portfolio_run(&timeline, &config, p->benchmark, &p->benchmark_stats);
+    free(p->score);
+    free(p->order);
+    p->score = nullptr;
+    p->order = nullptr;
+    lv_timeline_free(&timeline);
+    free(series);
+    p->version    = next_plot_version();
+    p->elapsed_ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void show_portfolio(backtest_portfolio* p, const backtest_view* v, const chart* charts, size_t count) {
+    ImGui::PushItemWidth(ImGui::GetFontSize() * 8.0f);
+    ImGui::SliderInt("Lookback", &p->lookback, 1, 500);
+    ImGui::SameLine();
+    ImGui::SliderInt("Hold Top", &p->top, 1, 500);
+    ImGui::SameLine();
+    ImGui::SliderInt("Rebalance Every", &p->rebalance, 1, 250);
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Button("Run Portfolio"))
+        portfolio_run(p, v, charts, count);
+
+    if (p->status != 0) {
+        ImGui::TextDisabled("momentum rotation over every loaded symbol, with the costs of the Backtest tab");
+        return;
+    }
+    const lv_backtest_stats& s = p->stats.performance;
+    ImGui::Text("%zu symbols x %zu steps  return %+.2f%%  CAGR %+.2f%%  max DD %.2f%%  Sharpe %.2f  turnover %.1fx/yr  (%.1f ms)",
+                p->symbols, p->size, s.total_return * 100.0, s.cagr * 100.0, s.max_drawdown * 100.0, s.sharpe, s.turnover, p->elapsed_ms);
+    ImGui::TextDisabled("memory: index map %.1f MB, rows %.1f KB", p->stats.timeline_bytes / 1048576.0, p->stats.working_bytes / 1024.0);
+    if (ImPlot::BeginPlot("##portfolio", ImVec2(-1, -1))) {
+        ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
+        ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Time);
+        ImPlot::SetNextLineLOD(p->version);
+        ImPlot::PlotLine("Momentum", p->time, p->equity, (int)p->size, ImPlotLineFlags_Downsample);
+        ImPlot::SetNextLineLOD(p->version);
+        ImPlot::PlotLine("Equal Weight", p->time, p->benchmark, (int)p->size, ImPlotLineFlags_Downsample);
+        ImPlot::EndPlot();
+    }
+}
+
+// Walk-forward test of the Sweep tab's crossover grid on the active chart.
+// Each fold trades the windows with the best Sharpe over the preceding train
+// bars; the out-of-sample folds are stitched into one equity curve. Runs on
+// demand and blocks the frame, lv_walkforward spreads the work over all cores.
+struct backtest_walkforward {
+    int                   train;        // bars
+    int                   test;
+    const chart*          source;       // chart and generation the results belong to
+    unsigned              generation;
+    double*               prefix;       // sums of close of the source, during a run
+    int                   fast_lo, fast_step, cols;
+    int                   slow_lo, slow_step, rows;
+    double                below;
+    lv_walkforward_result result;
+    int                   status;       // of the last run, -1 before the first
+    double*               benchmark;    // buy and hold over the out-of-sample bars
+    double                elapsed_ms;
+    ImU64                 version;      // plot version of both curves, new per run
+};
+
+static int walkforward_positions(void* user, size_t param, size_t first, size_t last, double* position) {
+    const backtest_walkforward* w = (const backtest_walkforward*)user;
+    const size_t fast = (size_t)(w->fast_lo + (int)(param % w->cols) * w->fast_step);
+    const size_t slow = (size_t)(w->slow_lo + (int)(param / w->cols) * w->slow_step);
+    if (fast >= slow || slow >= w->source->candles.size)
+        return -1;
+    crossover_positions(w->prefix, fast, slow, w->below, first, last, position);
+    return 0;
+}
+
+static void walkforward_free(backtest_walkforward* w) {
+    if (w->status == 0)
+        lv_walkforward_free(&w->result);
+    free(w->benchmark);
+    w->benchmark = nullptr;
+    w->status    = -1;
+}
+
+static void walkforward_run(backtest_walkforward* w, const backtest_sweep* s, const backtest_view* v, const chart* c) {
+    walkforward_free(w);
+    const lv_candles* candles = &c->candles;
+    const size_t n = candles->size;
+    w->source     = c;
+    w->generation = c->generation;
+    if (n <= (size_t)w->train)
+        return;
+    uint64_t t0 = SDL_GetPerformanceCounter();
+    w->prefix = (double*)malloc(sizeof(double) * (n + 1));
+    lv_prefix_sum(n, candles->close, w->prefix);
+    crossover_grid(s->fast_range, s->resolution, &w->fast_lo, &w->fast_step, &w->cols);
+    crossover_grid(s->slow_range, s->resolution, &w->slow_lo, &w->slow_step, &w->rows);
+    w->below = v->long_short ? -1.0 : 0.0;
+    lv_walkforward_config config = {
+        (size_t)w->train, (size_t)w->test, (size_t)(w->cols * w->rows), walkforward_positions, w,
+        { (lv_fill)v->fill, v->commission_bps * 1e-4, v->slippage_bps * 1e-4, 0.0 }, 0
+    };
+    w->status = lv_walkforward(candles, &config, &w->result);
+    free(w->prefix);
+    w->prefix = nullptr;
+    w->elapsed_ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    w->version    = next_plot_version();
+    if (w->status != 0)
+        return;
+    const size_t first = w->result.first;
+    w->benchmark = (double*)malloc(sizeof(double) * (n - first));
+    for (size_t i = first; i < n; i++)
+        w->benchmark[i - first] = candles->close[i] / candles->close[first];
+}
+
+static void show_walkforward(backtest_walkforward* w, const backtest_sweep* s, const backtest_view* v, const chart* c) {
+    ImGui::PushItemWidth(ImGui::GetFontSize() * 8.0f);
+    ImGui::DragInt("Train", &w->train, 1.0f, 20, 100000);
+    ImGui::SameLine();
+    ImGui::DragInt("Test", &w->test, 1.0f, 5, 100000);
+    ImGui::PopItemWidth();
+    w->train = ImMax(w->train, 20);
+    w->test  = ImMax(w->test, 5);
+    ImGui::SameLine();
+    if (ImGui::Button("Run Walk-Forward") && c->status == chart_ready)
+        walkforward_run(w, s, v, c);
+
+    const bool current = w->source == c && w->generation == c->generation;
+    if (!current || w->status != 0) {
+        ImGui::TextDisabled("%s: %s", c->symbol, c->status != chart_ready ? "no data" :
+                            current ? "not enough bars for one training window" :
+                            "crossover grid and costs of the Sweep and Backtest tabs");
+        return;
+    }
+    const lv_walkforward_result& r = w->result;
+    const lv_backtest_stats& st = r.stats;
+    ImGui::Text("%s  %zu folds  out of sample: return %+.2f%%  CAGR %+.2f%%  max DD %.2f%%  Sharpe %.2f  (%.1f ms)",
+                c->symbol, r.folds, st.total_return * 100.0, st.cagr * 100.0, st.max_drawdown * 100.0, st.sharpe, w->elapsed_ms);
+
+    const size_t params = (size_t)(w->cols * w->rows);
+    const int n = (int)(c->candles.size - r.first);
+    double* starts = frame_alloc_array<double>(&frame_scratch, r.folds);
+    for (size_t k = 0; k < r.folds; k++)
+        starts[k] = (double)(r.first + k * (size_t)w->test);
+    chart_frame frame = {};
+    if (ImPlot::BeginPlot("##walkforward", ImVec2(-1, ImGui::GetContentRegionAvail().y * 0.65f))) {
+        ImPlot::SetupAxes(nullptr, nullptr, 0, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, (double)r.first - 1, (double)c->candles.size + 3, ImPlotCond_Once);
+        ImPlotPlot* plot = ImPlot::GetCurrentPlot();
+        ImPlotRange x_prev = plot->Axes[ImAxis_X1].Range;
+        float plot_px = plot->PlotRect.GetWidth() > 0 ? plot->PlotRect.GetWidth() : ImGui::GetContentRegionAvail().x;
+        chart_frame_ticks(&frame, c, x_prev.Min - x_prev.Size(), x_prev.Max + x_prev.Size(), plot_px * 3.0f);
+        setup_pane_ticks(&frame);
+        ImPlot::SetNextLineStyle(ImVec4(0.5f, 0.5f, 0.5f, 0.35f));
+        ImPlot::PlotInfLines("Folds", starts, (int)r.folds);
+        ImPlot::SetNextLineLOD(w->version);
+        ImPlot::PlotLine("Walk-Forward", r.equity, n, 1.0, (double)r.first, ImPlotLineFlags_Downsample);
+        ImPlot::SetNextLineLOD(w->version);
+        ImPlot::PlotLine("Buy & Hold", w->benchmark, n, 1.0, (double)r.first, ImPlotLineFlags_Downsample);
+        ImPlot::EndPlot();
+    }
+    if (ImGui::BeginTable("##folds", 5, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchSame)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Fold");
+        ImGui::TableSetupColumn("Fast");
+        ImGui::TableSetupColumn("Slow");
+        ImGui::TableSetupColumn("Train Sharpe");
+        ImGui::TableSetupColumn("Test Return");
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)r.folds);
+        while (clipper.Step()) {
+            for (int k = clipper.DisplayStart; k < clipper.DisplayEnd; k++) {
+                const size_t p = r.chosen[k];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("%d", k + 1);
+                if (p < params) {
+                    ImGui::TableNextColumn(); ImGui::Text("%d", w->fast_lo + (int)(p % w->cols) * w->fast_step);
+                    ImGui::TableNextColumn(); ImGui::Text("%d", w->slow_lo + (int)(p / w->cols) * w->slow_step);
+                } else {
+                    ImGui::TableNextColumn(); ImGui::TextDisabled("flat");
+                    ImGui::TableNextColumn();
+                }
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", r.train_sharpe[k]);
+                ImGui::TableNextColumn(); ImGui::Text("%+.2f%%", r.test_return[k] * 100.0);
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+#ifdef IMTRADE_PROFILE
+// Stacked per-stage frame times, oldest frame on the left. "Other" is the rest
+// of the frame, mostly building the UI outside of plot_candles.
+static void show_profiler(bool* open) {
+    const int n = profile.count;
+    if (n == 0)
+        return;
+    const int first = (profile.head - n + 1 + profile_frames) % profile_frames;
+    double* xs    = frame_alloc_array<double>(&frame_scratch, n);
+    double* stack = frame_alloc_array<double>(&frame_scratch, (size_t)n * (profile_stage_count + 2));
+    double* sorted = frame_alloc_array<double>(&frame_scratch, n);
+    for (int i = 0; i < n; i++) {
+        const int slot = (first + i) % profile_frames;
+        double sum = 0.0;
+        xs[i] = (double)(i - n + 1);
+        stack[i] = 0.0;
+        for (int s = 0; s < profile_stage_count; s++) {
+            sum += profile.ms[slot][s];
+            stack[(size_t)(s + 1) * n + i] = sum;
+        }
+        stack[(size_t)(profile_stage_count + 1) * n + i] = ImMax(sum, profile.total_ms[slot]);
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(520, 420), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Frame Profiler", open)) {
+        // The newest slot is still being timed; percentiles skip it.
+        const int done = n - 1;
+        if (ImGui::BeginTable("##stages", 3, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Stage");
+            ImGui::TableSetupColumn("p50 ms");
+            ImGui::TableSetupColumn("p99 ms");
+            ImGui::TableHeadersRow();
+            for (int s = 0; s <= profile_stage_count; s++) {
+                for (int i = 0; i < done; i++) {
+                    const int slot = (first + i) % profile_frames;
+                    sorted[i] = s < profile_stage_count ? profile.ms[slot][s] : profile.total_ms[slot];
+                }
+                double p50 = 0.0, p99 = 0.0;
+                if (done > 0) {
+                    std::nth_element(sorted, sorted + done / 2, sorted + done);
+                    p50 = sorted[done / 2];
+                    std::nth_element(sorted, sorted + done * 99 / 100, sorted + done);
+                    p99 = sorted[done * 99 / 100];
+                }
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(s < profile_stage_count ? profile_stage_names[s] : "Frame");
+                ImGui::TableNextColumn(); ImGui::Text("%7.3f", p50);
+                ImGui::TableNextColumn(); ImGui::Text("%7.3f", p99);
+            }
+            ImGui::EndTable();
+        }
+        if (done > 0) {
+            const int last = (first + done - 1) % profile_frames;
+            ImGui::Text("last frame: %d vtx  %d idx  %d draw cmds", profile.vtx[last], profile.idx[last], profile.cmds[last]);
+        }
+        if (ImPlot::BeginPlot("##frame_times", ImVec2(-1, -1), ImPlotFlags_NoMenus)) {
+            ImPlot::SetupAxes("frame", "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, -(double)profile_frames, 0.0, ImPlotCond_Always);
+            ImPlot::SetupLegend(ImPlotLocation_NorthWest);
+            for (int s = 0; s <= profile_stage_count; s++) {
+                const char* name = s < profile_stage_count ? profile_stage_names[s] : "Other";
+                ImPlot::PlotShaded(name, xs, stack + (size_t)s * n, stack + (size_t)(s + 1) * n, done);
+            }
+            ImPlot::EndPlot();
+        }
+    }
+    ImGui::End();
+}
+#endif
+
+// Where candles come from, shared by the window and --png:
+//   --market M  --interval I  --replay-dir DIR  --latency MS  --bandwidth BYTES_PER_SEC  --record
+struct fetch_options {
+    const char*      market;
+    const char*      interval;
+    lv_replay_config replay;
+};
+
+static const char* fetch_usage = "[--market sina|synth|replay] [--interval I] [--replay-dir DIR] [--latency MS] [--bandwidth B/s] [--record]";
+
+// Returns how many arguments starting at argv[i] were consumed, 0 if argv[i] is not a fetch option.
+static int parse_fetch_option(int argc, char** argv, int i, fetch_options* o) {
+    if (strcmp(argv[i], "--record") == 0) {
+        o->replay.record = 1;
+        return 1;
+    }
+    if (i + 1 >= argc)
+        return 0;
+    const char* value = argv[i + 1];
+    if (strcmp(argv[i], "--market") == 0)            o->market = value;
+    else if (strcmp(argv[i], "--interval") == 0)     o->interval = value;
+    else if (strcmp(argv[i], "--replay-dir") == 0)   o->replay.dir = value;
+    else if (strcmp(argv[i], "--latency") == 0)      o->replay.latency_ms = (unsigned)atoi(value);
+    else if (strcmp(argv[i], "--bandwidth") == 0)    o->replay.bytes_per_sec = (size_t)strtoull(value, nullptr, 10);
+    else return 0;
+    return 2;
+}
+
+static const char* default_symbols[] = { "sh000001", "sz399001", "sz399006", "sh000300", "sh000016", "sh000905" };
+
+// Headless reports: every symbol is drawn with the chart tab's layout into an
+// SDL software renderer and written out as <dir>/<symbol>.png. Symbols are
+// striped over forked worker processes, each with its own ImGui context.
+
+// Growable output buffer with an LSB-first bit writer for deflate.
+struct png_buffer {
+    unsigned char* data;
+    size_t         size;
+    size_t         cap;
+    uint32_t       bits;
+    int            nbits;
+};
+
+static void png_put(png_buffer* b, const void* src, size_t n) {
+    if (b->size + n > b->cap) {
+        while (b->size + n > b->cap)
+            b->cap = b->cap ? b->cap * 2 : 64 * 1024;
+        b->data = (unsigned char*)realloc(b->data, b->cap);
+    }
+    memcpy(b->data + b->size, src, n);
+    b->size += n;
+}
+
+static void png_put_u32(png_buffer* b, uint32_t v) {
+    unsigned char be[4] = { (unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v };
+    png_put(b, be, 4);
+}
+
+static void png_bits(png_buffer* b, uint32_t v, int n) {
+    b->bits |= v << b->nbits;
+    b->nbits += n;
+    while (b->nbits >= 8) {
+        unsigned char byte = (unsigned char)b->bits;
+        png_put(b, &byte, 1);
+        b->bits >>= 8;
+        b->nbits -= 8;
+    }
+}
+
+// Huffman codes go out most significant bit first.
+static void png_code(png_buffer* b, uint32_t code, int n) {
+    uint32_t rev = 0;
+    for (int i = 0; i < n; i++)
+        rev |= ((code >> i) & 1) << (n - 1 - i);
+    png_bits(b, rev, n);
+}
+
+// Fixed Huffman literal/length alphabet (RFC 1951, 3.2.6).
+static void png_symbol(png_buffer* b, int sym) {
+    if (sym < 144)      png_code(b, 0x30 + sym, 8);
+    else if (sym < 256) png_code(b, 0x190 + sym - 144, 9);
+    else if (sym < 280) png_code(b, sym - 256, 7);
+    else                png_code(b, 0xc0 + sym - 280, 8);
+}
+
+static void png_run(png_buffer* b, int len) {
+    static const int base[]  = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+    static const int extra[] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+    int k = 28;
+    while (base[k] > len)
+        k--;
+    png_symbol(b, 257 + k);
+    png_bits(b, (uint32_t)(len - base[k]), extra[k]);
+    png_code(b, 0, 5); // distance 1
+}
+
+static uint32_t png_crc(const unsigned char* p, size_t n, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++)
+        crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void png_chunk(png_buffer* out, const char* type, const unsigned char* data, size_t n) {
+    png_put_u32(out, (uint32_t)n);
+    png_put(out, type, 4);
+    if (n)
+        png_put(out, data, n);
+    png_put_u32(out, png_crc(data, n, png_crc((const unsigned char*)type, 4)));
+}
+
+// RGBA8 image to PNG. Rows use the Sub filter and the stream only codes runs
+// (distance 1 matches): charts are mostly flat colour, which filters to long
+// zero runs, so files come out around 1/16 of raw size without pulling in zlib.
+static int write_png(const char* path, const unsigned char* rgba, int w, int h, png_buffer* z, png_buffer* out) {
+    z->size = 0; z->bits = 0; z->nbits = 0;
+    out->size = 0;
+    const unsigned char zhdr[2] = { 0x78, 0x01 };
+    png_put(z, zhdr, 2);
+    png_bits(z, 1, 1); // final block
+    png_bits(z, 1, 2); // fixed Huffman
+    uint32_t s1 = 1, s2 = 0;
+    int prev = -1, run = 0;
+    const size_t stride = (size_t)w * 4;
+    for (int y = 0; y <= h; y++) {
+        for (size_t x = 0; y < h && x <= stride; x++) {
+            const unsigned char* row = rgba + stride * y;
+            int v = x == 0 ? 1 : (unsigned char)(row[x - 1] - (x > 4 ? row[x - 5] : 0));
+            s1 = (s1 + v) % 65521;
+            s2 = (s2 + s1) % 65521;
+            if (v == prev && run < 258) {
+                run++;
+                continue;
+            }
+            if (run >= 3)
+                png_run(z, run);
+            else
+                for (int k = 0; k < run; k++)
+                    png_symbol(z, prev);
+            png_symbol(z, v);
+            prev = v;
+            run = 0;
+        }
+    }
+    if (run >= 3)
+        png_run(z, run);
+    else
+        for (int k = 0; k < run; k++)
+            png_symbol(z, prev);
+    png_symbol(z, 256);
+    png_bits(z, 0, 7); // flush to a byte
+    png_put_u32(z, (s2 << 16) | s1);
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    unsigned char ihdr[13] = { (unsigned char)(w >> 24), (unsigned char)(w >> 16), (unsigned char)(w >> 8), (unsigned char)w,
+                               (unsigned char)(h >> 24), (unsigned char)(h >> 16), (unsigned char)(h >> 8), (unsigned char)h,
+                               8, 6, 0, 0, 0 };
+    png_put(out, signature, 8);
+    png_chunk(out, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(out, "IDAT", z->data, z->size);
+    png_chunk(out, "IEND", nullptr, 0);
+
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr)
+        return -1;
+    size_t written = fwrite(out->data, 1, out->size, f);
+    return fclose(f) == 0 && written == out->size ? 0 : -1;
+}
+
+struct headless_options {
+    const char*   out_dir;
+    fetch_options fetch;
+    int           jobs;
+    int         width, height;
+};
+
+static const int headless_frames = 2; // the first frame settles layout and autofit
+
+// Renders symbols[worker], symbols[worker + workers], ... and returns how many were written.
+static int headless_worker(const headless_options* o, const char** symbols, size_t count, int worker, int workers) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, o->width, o->height, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (renderer == nullptr) {
+        fprintf(stderr, "headless: %s\n", SDL_GetError());
+        return 0;
+    }
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2((float)o->width, (float)o->height);
+    io.DeltaTime   = 1.0f / 60.0f;
+    ImGui::StyleColorsDark();
+    ImGui_ImplSDLRenderer2_Init(renderer);
+    ImPlot::GetStyle().UseLocalTime = false;
+
+    unsigned char* pixels = (unsigned char*)malloc((size_t)o->width * o->height * 4);
+    png_buffer z = {}, out = {};
+    char path[1024];
+    int written = 0;
+    chart c = {};
+    for (size_t i = worker; i < count; i += workers) {
+        chart_init(&c, symbols[i], 100);
+        c.staged_result = lv_candles_fetch(&c.staged, o->fetch.market, c.symbol, o->fetch.interval);
+        chart_adopt(&c);
+        if (c.status != chart_ready) {
+            fprintf(stderr, "headless: %s: fetch failed\n", c.symbol);
+            chart_free(&c);
+            continue;
+        }
+        for (int f = 0; f < headless_frames; f++) {
+            frame_arena_reset(&frame_scratch);
+            ImGui_ImplSDLRenderer2_NewFrame();
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("##report", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+            ImGui::Text("%s  %s  %zu bars", c.symbol, o->fetch.interval, c.candles.size);
+            plot_chart("##report", &c, false);
+            ImGui::End();
+            ImGui::Render();
+        }
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
+        snprintf(path, sizeof(path), "%s/%s.png", o->out_dir, c.symbol);
+        if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, pixels, o->width * 4) == 0 &&
+            write_png(path, pixels, o->width, o->height, &z, &out) == 0)
+            written++;
+        else
+            fprintf(stderr, "headless: %s: cannot write %s\n", c.symbol, path);
+        chart_free(&c);
+    }
+    free(z.data);
+    free(out.data);
+    free(pixels);
+    ImGui_ImplSDLRenderer2_Shutdown();
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    frame_arena_reset(&frame_scratch);
+    return written;
+}
+
+// imtrade --png DIR [--jobs N] [--size WxH] [fetch options] [SYMBOL...]
+static int headless_main(int argc, char** argv) {
+    headless_options o = { argv[2], { "sina", "1d", { "replay", 0, 0, 0 } }, (int)std::thread::hardware_concurrency(), 1280, 720 };
+    int i = 3;
+    while (i < argc && strncmp(argv[i], "--", 2) == 0) {
+        int used = parse_fetch_option(argc, argv, i, &o.fetch);
+        if (used == 0 && i + 1 < argc) {
+            used = 2;
+            if (strcmp(argv[i], "--jobs") == 0)       o.jobs = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--size") == 0)  sscanf(argv[i + 1], "%dx%d", &o.width, &o.height);
+            else used = 0;
+        }
+        if (used == 0)
+            break;
+        i += used;
+    }
+    if (o.out_dir == nullptr || (i < argc && strncmp(argv[i], "--", 2) == 0) || o.width <= 0 || o.height <= 0) {
+        fprintf(stderr, "usage: %s --png DIR [--jobs N] [--size WxH] %s [SYMBOL...]\n", argv[0], fetch_usage);
+        return 1;
+    }
+    lv_replay_configure(&o.fetch.replay);
+    const char** symbols = i < argc ? (const char**)argv + i : default_symbols;
+    size_t count = i < argc ? (size_t)(argc - i) : IM_ARRAYSIZE(default_symbols);
+    o.jobs = ImClamp(o.jobs, 1, (int)ImMax(count, (size_t)1));
+
+    // Nothing may have started a thread before the fork.
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    int written = 0;
+#ifdef _WIN32
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    o.jobs = 1;
+    written = headless_worker(&o, symbols, count, 0, 1);
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    for (int w = 0; w < o.jobs; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            int n = headless_worker(&o, symbols, count, w, o.jobs);
+            ssize_t r = write(fds[1], &n, sizeof(n));
+            _exit(r == (ssize_t)sizeof(n) ? 0 : 1);
+        }
+        if (pid < 0) {
+            perror("fork");
+            o.jobs = w;
+            break;
+        }
+    }
+    close(fds[1]);
+    int n;
+    while (read(fds[0], &n, sizeof(n)) == (ssize_t)sizeof(n))
+        written += n;
+    close(fds[0]);
+    while (wait(nullptr) > 0) {}
+#endif
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+    printf("%d/%zu charts in %.2f s with %d workers, %.1f charts/s\n", written, count, secs, o.jobs, secs > 0 ? written / secs : 0.0);
+    return written == (int)count ? 0 : 1;
 }
 
 // Main code
-int main(int, char**) {
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "--png") == 0)
+        return headless_main(argc, argv);
+
+    // Symbols come from the command line after any fetch options, the first one opens in the chart tab.
+    fetch_options fetch = { "sina", "1h", { "replay", 0, 0, 0 } };
+    int arg = 1;
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        int used = parse_fetch_option(argc, argv, arg, &fetch);
+        if (used == 0) {
+            fprintf(stderr, "usage: %s %s [SYMBOL...]\n       %s --png DIR ...\n", argv[0], fetch_usage, argv[0]);
+            return 1;
+        }
+        arg += used;
+    }
+    lv_replay_configure(&fetch.replay);
+    const char** symbols = arg < argc ? (const char**)argv + arg : default_symbols;
+    size_t symbol_count  = arg < argc ? (size_t)(argc - arg) : IM_ARRAYSIZE(default_symbols);
+
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
     // Setup SDL
@@ -190,6 +2390,7 @@ int main(int, char**) {
         printf("Error: %s\n", SDL_GetError());
         return -1;
     }
+    feed_event_type = SDL_RegisterEvents(1);
 
     // From 2.0.18: Enable native IME.
 #ifdef SDL_HINT_IME_SHOW_UI
@@ -209,12 +2410,15 @@ int main(int, char**) {
         SDL_Log("Error creating SDL_Renderer!");
         return -1;
     }
+    if (SDL_RenderTargetSupported(renderer))
+        layer_renderer = renderer;
     //SDL_RendererInfo info;
     //SDL_GetRendererInfo(renderer, &info);
     //SDL_Log("Current SDL_Renderer: %s", info.name);
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(imgui_counted_malloc, imgui_counted_free, &imgui_allocs);
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
@@ -253,11 +2457,53 @@ int main(int, char**) {
 
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
-    static lv_candles candles;
-    lv_candles_init(&candles, 100);
-    lv_candles_fetch(&candles, "sina", "sh000001", "1h");
+    chart* charts = (chart*)calloc(symbol_count, sizeof(chart));
+    for (size_t i = 0; i < symbol_count; i++)
+        chart_init(&charts[i], symbols[i], 100);
+    size_t active = 0;
+    static backtest_view backtest = backtest_view_defaults;
+    static backtest_sweep sweep = {};
+    sweep.fast_range[0] = 2;  sweep.fast_range[1] = 60;
+    sweep.slow_range[0] = 10; sweep.slow_range[1] = 250;
+    sweep.resolution = 48;
+    static backtest_montecarlo montecarlo = {};
+    montecarlo.paths  = 10000;
+    montecarlo.block  = 20;
+    montecarlo.seed   = 1;
+    montecarlo.status = -1;
+    static backtest_portfolio portfolio = {};
+    portfolio.lookback  = 20;
+    portfolio.top       = 3;
+    portfolio.rebalance = 5;
+    portfolio.status    = -1;
+    static backtest_walkforward walkforward = {};
+    walkforward.train  = 60;
+    walkforward.test   = 10;
+    walkforward.status = -1;
+    static chart_replay replay = {};
+    replay.start  = 200;
+    replay.speed  = 10.0f;
+    replay.follow = true;
+    replay.window = 200;
+    static chart_loader loader;
+    chart_loader_start(&loader, charts, symbol_count, fetch.market, fetch.interval);
+    geometry_pool_start(&geometry_workers);
+
+#ifdef LV_TRACE
+    // Written by the toolbar button and again at exit.
+    static const char* trace_path = "imtrade-trace.json";
+    LV_TRACE_THREAD("main");
+#endif
 
     // Main loop
+    static bool on_demand = true;
+    static bool show_alloc_overlay = false;
+#ifdef IMTRADE_PROFILE
+    static bool show_profile_overlay = false;
+#endif
+    uint64_t frame_new_allocs = 0, frame_new_bytes = 0;
+    uint64_t frame_imgui_allocs = 0, frame_imgui_bytes = 0;
+    int redraw_frames = redraw_cooldown_frames;
     bool done = false;
     while (!done) {
         // Poll and handle events (inputs, window resize, etc.)
@@ -265,24 +2511,64 @@ int main(int, char**) {
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+        // - In on-demand mode we block here once the cooldown frames are spent. A timeout without events still
+        //   draws a single frame, which is enough for cursor blink and hover delays.
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            ImGui_ImplSDL2_ProcessEvent(&event);
-            if (event.type == SDL_QUIT)
-                done = true;
-            if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(window))
-                done = true;
+        int wait_ms = 0;
+        if (on_demand && redraw_frames <= 0)
+            wait_ms = io.WantTextInput ? blink_wait_ms : idle_wait_ms;
+        bool pending = wait_ms > 0 ? SDL_WaitEventTimeout(&event, wait_ms) != 0 : SDL_PollEvent(&event) != 0;
+        // The frame clock starts after the idle wait so sleeping does not count.
+        PROFILE_FRAME_BEGIN();
+        LV_TRACE_SPAN("frame");
+        {
+            PROFILE_SCOPE(profile_events);
+            while (pending) {
+                ImGui_ImplSDL2_ProcessEvent(&event);
+                if (event.type == SDL_QUIT)
+                    done = true;
+                if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(window))
+                    done = true;
+                if (event.type == feed_event_type) {
+                    sweep_guard(&sweep, (chart*)event.user.data1);
+                    chart_adopt((chart*)event.user.data1);
+                }
+                // Target textures lose their contents with the device; rebake.
+                if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+                    for (size_t i = 0; i < symbol_count; i++)
+                        charts[i].layer.settled = 0;
+                    replay.view.layer.settled = 0;
+                }
+                // Input and feed updates alike restart the cooldown.
+                redraw_frames = redraw_cooldown_frames;
+                pending = SDL_PollEvent(&event) != 0;
+            }
         }
 
         if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) {
             SDL_Delay(10);
             continue;
         }
+        redraw_frames--;
+        // A running sweep fills the heatmap without posting events.
+        if (sweep.running)
+            redraw_frames = ImMax(redraw_frames, 1);
+        // So does a playing replay.
+        if (replay.playing)
+            redraw_frames = ImMax(redraw_frames, 1);
+
+        // Allocation snapshot for the frame about to be built. Deltas are shown next frame.
+        uint64_t new_allocs0 = new_allocs.count.load(), new_bytes0 = new_allocs.bytes.load();
+        uint64_t imgui_allocs0 = imgui_allocs.count.load(), imgui_bytes0 = imgui_allocs.bytes.load();
+        frame_arena_reset(&frame_scratch);
 
         // Start the Dear ImGui frame
         ImGui_ImplSDLRenderer2_NewFrame();
         ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
+        {
+            PROFILE_SCOPE(profile_new_frame);
+            ImGui::NewFrame();
+        }
 
         // ImGui::InputText("Market", market, sizeof(market));
         // ImGui::SameLine();
@@ -295,39 +2581,141 @@ int main(int, char**) {
         static bool tooltip = true;
         ImGui::Checkbox("Show Tooltip", &tooltip);
         ImGui::SameLine();
-        static ImVec4 bull_col = ImVec4(0.000f, 1.000f, 0.441f, 1.000f);
-        static ImVec4 bear_col = ImVec4(0.853f, 0.050f, 0.310f, 1.000f);
+        ImGui::Checkbox("On-demand Redraw", &on_demand);
+        ImGui::SameLine();
+        ImGui::Checkbox("Alloc Overlay", &show_alloc_overlay);
+        ImGui::SameLine();
+#ifdef IMTRADE_PROFILE
+        ImGui::Checkbox("Profiler", &show_profile_overlay);
+        ImGui::SameLine();
+#endif
+#ifdef LV_TRACE
+        if (ImGui::Button("Dump Trace"))
+            lv_trace_dump(trace_path);
+        ImGui::SameLine();
+#endif
+        if (layer_renderer) {
+            ImGui::Checkbox("Layer Cache", &layer_cache);
+            ImGui::SameLine();
+        }
+        if (!geometry_workers.workers.empty()) {
+            ImGui::Checkbox("Parallel Geometry", &parallel_geometry);
+            ImGui::SameLine();
+        }
         ImGui::SameLine(); ImGui::ColorEdit4("##Bull", &bull_col.x, ImGuiColorEditFlags_NoInputs);
         ImGui::SameLine(); ImGui::ColorEdit4("##Bear", &bear_col.x, ImGuiColorEditFlags_NoInputs);
         ImPlot::GetStyle().UseLocalTime = false;
 
-        // Create compressed continuous time axis
-        double* dates = new double[candles.size];
-        for (size_t i = 0; i < candles.size; i++) {
-            dates[i] = (double)i;
+        if (show_alloc_overlay) {
+            const float pad = 10.0f;
+            const ImGuiViewport* viewport = ImGui::GetMainViewport();
+            ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - pad, viewport->WorkPos.y + pad), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+            ImGui::SetNextWindowBgAlpha(0.35f);
+            ImGuiWindowFlags overlay_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+            if (ImGui::Begin("Allocations", &show_alloc_overlay, overlay_flags)) {
+                ImGui::Text("new:   %4llu allocs %8llu B", (unsigned long long)frame_new_allocs, (unsigned long long)frame_new_bytes);
+                ImGui::Text("imgui: %4llu allocs %8llu B", (unsigned long long)frame_imgui_allocs, (unsigned long long)frame_imgui_bytes);
+                ImGui::Text("arena: %zu / %zu B", frame_scratch.used, frame_scratch.cap);
+            }
+            ImGui::End();
         }
+#ifdef IMTRADE_PROFILE
+        if (show_profile_overlay)
+            show_profiler(&show_profile_overlay);
+#endif
 
-        if (ImPlot::BeginPlot("Real-time Candlestick Chart", ImVec2(-1,-1))) {
-            ImPlot::SetupAxes(nullptr, nullptr, 0, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
-            plot_candles("sh000001", &candles);
-            ImPlot::EndPlot();
+        replay_advance(&replay, io.DeltaTime);
+        if (ImGui::BeginTabBar("##views")) {
+            if (ImGui::BeginTabItem("Chart")) {
+                plot_chart(charts[active].symbol, &charts[active], tooltip);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Dashboard")) {
+                show_dashboard(charts, symbol_count, &active);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Backtest")) {
+                show_backtest(&backtest, &charts[active]);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Monte Carlo")) {
+                show_montecarlo(&montecarlo, &backtest, &charts[active]);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Sweep")) {
+                show_sweep(&sweep, &backtest, charts, symbol_count);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Portfolio")) {
+                show_portfolio(&portfolio, &backtest, charts, symbol_count);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Walk-Forward")) {
+                show_walkforward(&walkforward, &sweep, &backtest, &charts[active]);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Replay")) {
+                show_replay(&replay, &charts[active], tooltip);
+                ImGui::EndTabItem();
+            }
+            ImGui::EndTabBar();
         }
 
         // Rendering
-        ImGui::Render();
-        SDL_RenderSetScale(renderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
-        SDL_SetRenderDrawColor(renderer, (Uint8)(clear_color.x * 255), (Uint8)(clear_color.y * 255), (Uint8)(clear_color.z * 255), (Uint8)(clear_color.w * 255));
-        SDL_RenderClear(renderer);
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
-        SDL_RenderPresent(renderer);
+        {
+            PROFILE_SCOPE(profile_render);
+            ImGui::Render();
+        }
+        {
+            // Layer texture updates are submission work too.
+            PROFILE_SCOPE(profile_submit);
+            for (size_t i = 0; i < symbol_count; i++)
+                chart_layer_flush(&charts[i].layer, renderer);
+            if (replay.loaded)
+                chart_layer_flush(&replay.view.layer, renderer);
+            SDL_RenderSetScale(renderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
+            SDL_SetRenderDrawColor(renderer, (Uint8)(clear_color.x * 255), (Uint8)(clear_color.y * 255), (Uint8)(clear_color.z * 255), (Uint8)(clear_color.w * 255));
+            SDL_RenderClear(renderer);
+            ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
+        }
+        // Present waits for vsync, keep it out of the frame time.
+        PROFILE_FRAME_END(ImGui::GetDrawData());
+        {
+            LV_TRACE_SPAN("present");
+            SDL_RenderPresent(renderer);
+        }
+
+        frame_new_allocs = new_allocs.count.load() - new_allocs0;
+        frame_new_bytes = new_allocs.bytes.load() - new_bytes0;
+        frame_imgui_allocs = imgui_allocs.count.load() - imgui_allocs0;
+        frame_imgui_bytes = imgui_allocs.bytes.load() - imgui_bytes0;
     }
 
+    // Charts first: their layer draw lists are registered with the ImGui context.
+    chart_loader_stop(&loader);
+    geometry_pool_stop(&geometry_workers);
+    sweep_release(&sweep);
+    for (size_t i = 0; i < symbol_count; i++)
+        chart_free(&charts[i]);
+    free(charts);
+    replay_free(&replay);
+    backtest_view_free(&backtest);
+    montecarlo_free(&montecarlo);
+    walkforward_free(&walkforward);
+    portfolio_free(&portfolio);
+#ifdef LV_TRACE
+    if (lv_trace_dump(trace_path) == 0)
+        printf("trace written to %s\n", trace_path);
+#endif
+
     // Cleanup ImGui
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
 
     ImPlot::DestroyContext();
+    frame_arena_reset(&frame_scratch);
+    free(frame_scratch.data);
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -3,7 +3,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <curl/curl.h>
+#include <atomic>
+#include <mutex>
 
 #define min(a, b) ((a) < (b) ? (a) : (b))
 
@@ -12,7 +21,9 @@ static inline time_t parse_time(const char *datetime, const char *fmt) {
     return strptime(datetime, fmt, &tm) ? mktime(&tm) : -1;
 }
 
-static cJSON * curl_json(CURL *curl, const char *url) {
+// record_path, when set, receives a copy of a successful response body.
+static cJSON * curl_json(CURL *curl, const char *url, const char *record_path) {
+    LV_TRACE_SPAN("curl_json");
     cJSON *json = NULL;
     char *buf = NULL;
     size_t bufsz = 0;
@@ -23,6 +34,13 @@ static cJSON * curl_json(CURL *curl, const char *url) {
     CURLcode res = curl_easy_perform(curl);
     fclose(fs);
     if (res == CURLE_OK) json = cJSON_ParseWithLength(buf, bufsz);
+    if (json && record_path) {
+        FILE *rec = fopen(record_path, "wb");
+        if (rec) {
+            fwrite(buf, 1, bufsz, rec);
+            fclose(rec);
+        }
+    }
     free(buf);
     return json;
 }
@@ -42,15 +60,22 @@ static int sina_parse_interval_minutes(const char *interval) {
     return -1; // unsupported unit
 }
 
+static const char * sina_host = "http://money.finance.sina.com.cn";
+
+void lv_sina_set_host(const char *host) {
+    sina_host = host;
+}
+
 static int sina_init_url(const char * symbol, const char * interval, size_t limit, char * res, size_t size) {
-    static const char * url_fmt = "http://money.finance.sina.com.cn/quotes_service/api/json_v2.php/CN_MarketData.getKLineData?symbol=%s&scale=%d&datalen=%lu";
+    static const char * url_fmt = "%s/quotes_service/api/json_v2.php/CN_MarketData.getKLineData?symbol=%s&scale=%d&datalen=%lu";
     int interval_min = sina_parse_interval_minutes(interval);
-    if (interval_min < 0 || snprintf(res, size, url_fmt, symbol, interval_min, limit) < 0)
+    if (interval_min < 0 || snprintf(res, size, url_fmt, sina_host, symbol, interval_min, limit) < 0)
         return -1;
     return 0;
 }
 
 static int sina_parse_result(lv_candles * candles, cJSON * json) {
+    LV_TRACE_SPAN("sina_parse_result");
     if (!cJSON_IsArray(json)) return -1;
 
     int array_size = cJSON_GetArraySize(json);
@@ -59,8 +84,9 @@ static int sina_parse_result(lv_candles * candles, cJSON * json) {
     // Limit to available space
     int count = min(array_size, candles->cap);
 
-    for (int i = 0; i < count; i++) {
-        cJSON *item = cJSON_GetArrayItem(json, i);
+    // Walk the child list; cJSON_GetArrayItem() is linear per call.
+    int i = 0;
+    for (cJSON *item = json->child; item && i < count; item = item->next, i++) {
         if (!cJSON_IsObject(item)) continue;
 
         cJSON *day = cJSON_GetObjectItem(item, "day");
@@ -94,14 +120,261 @@ static int sina_parse_result(lv_candles * candles, cJSON * json) {
     return 0;
 }
 
+// Synthetic market. Log returns follow GBM with GARCH(1,1) variance, the
+// first bar of each session opens with an overnight gap, and volume follows
+// a U-shaped intraday profile scaled by the size of the move. The log price
+// is pulled back towards its start over a few years so that 10M-bar series
+// (centuries of data) stay in a plottable range. Sessions match
+// the A-share day (09:30-11:30, 13:00-15:00, Monday to Friday).
+//
+// Every random draw is a hash of (seed, bar, stream), so the output depends
+// only on the seed and not on the thread count. The GARCH/price recursion is
+// the one serial pass; drawing shocks and deriving high/low/volume/time run
+// in parallel chunks.
+#define SYNTH_START_YEAR   2000
+#define SYNTH_SESSION_MIN  240
+#define SYNTH_CHUNK        (1 << 16)
+#define SYNTH_MAX_THREADS  16
+
+enum { synth_shock, synth_gap, synth_high, synth_low, synth_volume, synth_streams };
+
+// Every (bar, stream, component) draws from its own counter; a normal takes
+// two components, so no two draws ever share an input to the hash.
+#define SYNTH_COMPONENTS   2
+
+typedef struct synth_params {
+    uint64_t seed;
+    int interval_min;
+    int bars_per_day;       // 1 for daily and longer bars
+    int days_per_bar;
+    double var_bar;         // long-run per-bar variance
+    double drift_bar;
+    double revert_bar;      // mean reversion of the log price per bar
+    double gap_sigma;
+    time_t epoch;           // local midnight of the first trading day, a Monday
+} synth_params;
+
+static inline uint64_t synth_hash(uint64_t x) {
+    // splitmix64 finaliser
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static inline double synth_uniform(const synth_params *p, size_t i, int stream, int component) {
+    uint64_t id = ((uint64_t)i * synth_streams + (uint64_t)stream) * SYNTH_COMPONENTS + (uint64_t)component;
+    uint64_t h = synth_hash(p->seed ^ synth_hash(id));
+    return ((double)(h >> 11) + 0.5) * (1.0 / 9007199254740992.0); // (0, 1)
+}
+
+static inline double synth_normal(const synth_params *p, size_t i, int stream) {
+    double u1 = synth_uniform(p, i, stream, 0), u2 = synth_uniform(p, i, stream, 1);
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+typedef struct synth_job {
+    const synth_params *params;
+    lv_candles *candles;
+    size_t size;
+    int pass;
+    size_t next_chunk;      // claimed under lock
+    pthread_mutex_t lock;
+} synth_job;
+
+// Pass 0 stores the return shocks in close[]. Pass 2 turns the per-bar sigma
+// left in high[] by the serial pass into high/low, then fills volume and time.
+static void synth_chunk(const synth_job *job, size_t first, size_t last) {
+    const synth_params *p = job->params;
+    lv_candles *c = job->candles;
+    for (size_t i = first; i < last; i++) {
+        if (job->pass == 0) {
+            c->close[i] = synth_normal(p, i, synth_shock);
+            continue;
+        }
+        double sigma = c->high[i];
+        double body_hi = c->open[i] > c->close[i] ? c->open[i] : c->close[i];
+        double body_lo = c->open[i] > c->close[i] ? c->close[i] : c->open[i];
+        c->high[i] = body_hi * exp(-0.5 * sigma * log(synth_uniform(p, i, synth_high, 0)));
+        c->low[i]  = body_lo * exp(0.5 * sigma * log(synth_uniform(p, i, synth_low, 0)));
+
+        size_t day = i / (size_t)p->bars_per_day;
+        int slot = (int)(i % (size_t)p->bars_per_day);
+        double x = p->bars_per_day > 1 ? ((double)slot + 0.5) / p->bars_per_day * 2.0 - 1.0 : 0.0;
+        double move = fabs(log(c->close[i] / c->open[i])) / sqrt(p->var_bar);
+        double noise = exp(0.3 * synth_normal(p, i, synth_volume));
+        c->volume[i] = (uint64_t)(1e5 * p->interval_min * (1.0 + 1.5 * x * x) * (0.5 + 0.5 * move) * noise);
+
+        // Trading day -> calendar day, skipping weekends. Bars are stamped
+        // with their closing minute like Sina's; daily bars with the date.
+        size_t tday = day * (size_t)p->days_per_bar;
+        size_t cal = tday / 5 * 7 + tday % 5;
+        int minute = 0;
+        if (p->bars_per_day > 1) {
+            int end = (slot + 1) * p->interval_min;
+            minute = end <= 120 ? 9 * 60 + 30 + end : 13 * 60 + end - 120;
+        }
+        c->timestamp[i] = p->epoch + (time_t)cal * 86400 + (time_t)minute * 60;
+    }
+}
+
+static void * synth_worker(void *arg) {
+    synth_job *job = (synth_job *)arg;
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        size_t chunk = job->next_chunk++;
+        pthread_mutex_unlock(&job->lock);
+        size_t first = chunk * SYNTH_CHUNK;
+        if (first >= job->size) return NULL;
+        synth_chunk(job, first, min(first + SYNTH_CHUNK, job->size));
+    }
+}
+
+static void synth_parallel(synth_job *job, int pass) {
+    job->pass = pass;
+    job->next_chunk = 0;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t chunks = (job->size + SYNTH_CHUNK - 1) / SYNTH_CHUNK;
+    int threads = (int)min((size_t)(cpus > 0 ? cpus : 1), min(chunks, (size_t)SYNTH_MAX_THREADS));
+    pthread_t tids[SYNTH_MAX_THREADS];
+    int started = 0;
+    while (started < threads - 1 && pthread_create(&tids[started], NULL, synth_worker, job) == 0)
+        started++;
+    synth_worker(job);
+    for (int t = 0; t < started; t++)
+        pthread_join(tids[t], NULL);
+}
+
+int lv_candles_synth(lv_candles *candles, uint64_t seed, const char *interval, size_t n) {
+    LV_TRACE_SPAN("lv_candles_synth");
+    int interval_min = sina_parse_interval_minutes(interval);
+    if (!candles || interval_min <= 0 || n == 0 || n > candles->cap) return -1;
+
+    synth_params p;
+    p.seed = synth_hash(seed);
+    p.interval_min = interval_min;
+    p.bars_per_day = interval_min < SYNTH_SESSION_MIN ? SYNTH_SESSION_MIN / interval_min : 1;
+    p.days_per_bar = interval_min < SYNTH_SESSION_MIN ? 1 : interval_min / SYNTH_SESSION_MIN;
+    double bars_per_year = 252.0 * p.bars_per_day / p.days_per_bar;
+    p.var_bar = 0.2 * 0.2 / bars_per_year;   // 20% annualised volatility
+    p.drift_bar = 0.05 / bars_per_year;
+    p.revert_bar = 1.0 / (5.0 * bars_per_year);
+    p.gap_sigma = 0.5 * sqrt(p.var_bar * p.bars_per_day);
+    struct tm start = {0};
+    start.tm_year = SYNTH_START_YEAR - 1900;
+    start.tm_mday = 3;                        // 2000-01-03, a Monday
+    start.tm_isdst = -1;
+    p.epoch = mktime(&start);
+
+    synth_job job;
+    job.params = &p;
+    job.candles = candles;
+    job.size = n;
+    pthread_mutex_init(&job.lock, NULL);
+    synth_parallel(&job, 0);
+
+    // GARCH(1,1): h = omega + alpha * e^2 + beta * h, long-run mean var_bar.
+    const double alpha = 0.08, beta = 0.9, omega = (1.0 - alpha - beta) * p.var_bar;
+    double h = p.var_bar;
+    const double anchor = log(10.0 + (double)(synth_hash(p.seed) % 99000) / 100.0);
+    double lp = anchor, price = exp(lp);
+    for (size_t i = 0; i < n; i++) {
+        double open = price;
+        if (p.bars_per_day > 1 && i % (size_t)p.bars_per_day == 0 && i > 0) {
+            lp += p.gap_sigma * synth_normal(&p, i, synth_gap);
+            open = exp(lp);
+        }
+        double sigma = sqrt(h);
+        double e = sigma * candles->close[i];
+        lp += p.drift_bar - 0.5 * h + e - p.revert_bar * (lp - anchor);
+        price = exp(lp);
+        candles->open[i] = open;
+        candles->close[i] = price;
+        candles->high[i] = sigma;
+        h = omega + alpha * e * e + beta * h;
+    }
+
+    synth_parallel(&job, 2);
+    pthread_mutex_destroy(&job.lock);
+    candles->size = n;
+    return 0;
+}
+
+// The symbol picks the seed, so every symbol is its own reproducible series.
+static int synth_fetch(lv_candles *candles, const char *symbol, const char *interval) {
+    uint64_t seed = 1469598103934665603ull;  // FNV-1a
+    for (const char *c = symbol; *c; c++)
+        seed = (seed ^ (unsigned char)*c) * 1099511628211ull;
+    return lv_candles_synth(candles, seed, interval, candles->cap);
+}
+
+// Replay market. Serves response bodies recorded by live fetches (see
+// lv_replay_config.record) from <dir>/<symbol>_<interval>.json. Files are
+// mmap'd and parsed in place; throttling sleeps for the configured latency
+// plus the time the body would take at the configured bandwidth.
+static lv_replay_config replay_config = {"replay", 0, 0, 0};
+
+void lv_replay_configure(const lv_replay_config *config) {
+    replay_config = *config;
+}
+
+static int replay_path(const char *symbol, const char *interval, char *res, size_t size) {
+    if (strchr(symbol, '/') || strchr(interval, '/')) return -1;
+    int n = snprintf(res, size, "%s/%s_%s.json", replay_config.dir, symbol, interval);
+    return n < 0 || (size_t)n >= size ? -1 : 0;
+}
+
+static void replay_throttle(size_t bytes) {
+    double secs = replay_config.latency_ms / 1000.0;
+    if (replay_config.bytes_per_sec) secs += (double)bytes / (double)replay_config.bytes_per_sec;
+    if (secs <= 0.0) return;
+    struct timespec ts;
+    ts.tv_sec = (time_t)secs;
+    ts.tv_nsec = (long)((secs - (double)ts.tv_sec) * 1e9);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+static int replay_fetch(lv_candles *candles, const char *symbol, const char *interval) {
+    LV_TRACE_SPAN("replay_fetch");
+    char path[1024];
+    if (replay_path(symbol, interval, path, sizeof(path)) < 0) return -1;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void *body = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (body == MAP_FAILED) return -1;
+    madvise(body, size, MADV_SEQUENTIAL);
+
+    replay_throttle(size);
+    int result = -1;
+    cJSON *json = cJSON_ParseWithLength((const char *)body, size);
+    if (json) {
+        result = sina_parse_result(candles, json);
+        cJSON_Delete(json);
+    }
+    munmap(body, size);
+    return result;
+}
+
+// Markets either build a URL and parse the JSON response, or fill the
+// candles themselves through fetch.
 typedef struct market_impl {
     const char* name;
     int (*init_url)(const char * symbol, const char * interval, size_t limit, char * res, size_t size);
     int (*parse_result)(lv_candles * candles, cJSON * json);
+    int (*fetch)(lv_candles * candles, const char * symbol, const char * interval);
 } market_impl;
 
 static const market_impl markets[] = {
-    {.name = "sina", .init_url = sina_init_url, .parse_result = sina_parse_result},
+    {.name = "sina", .init_url = sina_init_url, .parse_result = sina_parse_result, .fetch = NULL},
+    {.name = "synth", .init_url = NULL, .parse_result = NULL, .fetch = synth_fetch},
+    {.name = "replay", .init_url = NULL, .parse_result = NULL, .fetch = replay_fetch},
 };
 
 static const market_impl * find_market(const char * market) {
@@ -132,12 +405,27 @@ void lv_candles_free(lv_candles *candles) {
     free(candles->volume);
 }
 
+int lv_candles_append(lv_candles *candles, time_t timestamp, double open, double high, double low, double close, uint64_t volume) {
+    if (!candles || candles->size >= candles->cap) return -1;
+    size_t i = candles->size;
+    candles->timestamp[i] = timestamp;
+    candles->open[i] = open;
+    candles->high[i] = high;
+    candles->low[i] = low;
+    candles->close[i] = close;
+    candles->volume[i] = volume;
+    candles->size = i + 1;
+    return 0;
+}
+
 int lv_candles_fetch(lv_candles *candles, const char *market, const char *symbol, const char *interval) {
+    LV_TRACE_SPAN("lv_candles_fetch");
     if (!candles || !symbol || !interval) return -1;
 
     // Find market implementation
     const market_impl *impl = find_market(market);
     if (!impl) return -1;
+    if (impl->fetch) return impl->fetch(candles, symbol, interval);
 
     // Generate URL
     char url[1024];
@@ -148,7 +436,9 @@ int lv_candles_fetch(lv_candles *candles, const char *market, const char *symbol
     CURL *curl = curl_easy_init();
     if (!curl) return -1;
 
-    cJSON *json = curl_json(curl, url);
+    char record[1024];
+    bool recording = replay_config.record && replay_path(symbol, interval, record, sizeof(record)) == 0;
+    cJSON *json = curl_json(curl, url, recording ? record : NULL);
     int result = -1;
 
     if (json && impl->parse_result) {
@@ -162,6 +452,7 @@ int lv_candles_fetch(lv_candles *candles, const char *market, const char *symbol
 }
 
 void lv_indicator_ma(size_t winsz, size_t sz, const double *in, double *ou) {
+    LV_TRACE_SPAN("lv_indicator_ma");
     assert(winsz > 0 && sz > 0 && winsz < sz);
 
     double sum = 0.0;
@@ -179,20 +470,252 @@ void lv_indicator_ma(size_t winsz, size_t sz, const double *in, double *ou) {
     }
 }
 
-#if 0
-#include "cJSON.cpp"
-int main(int argc, const char *argv[])
-{
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    int sz = 100000;
-    lv_candles candles;
-    lv_candles_init(&candles, sz);
-    // lv_candles_fetch(&candles, NULL, "sh000001", "30");
-    double *ou = (double *) malloc(sizeof(double)*sz);
-    if (ou == NULL) return -1;
-    lv_indicator_ma(100, sz, candles.close, ou);
-    lv_candles_free(&candles);
-    free(ou);
-    return 0;
+void lv_indicator_ema(size_t period, size_t sz, const double *in, double *ou) {
+    LV_TRACE_SPAN("lv_indicator_ema");
+    assert(period > 0 && sz > 0 && period < sz);
+
+    // seed with the simple average of the first window
+    double sum = 0.0;
+    for (size_t i = 0; i < period; i++) sum += in[i];
+    ou[period - 1] = sum / (double)period;
+
+    const double k = 2.0 / (double)(period + 1);
+    for (size_t i = period; i < sz; i++) {
+        ou[i] = ou[i - 1] + k * (in[i] - ou[i - 1]);
+    }
+
+    for (size_t i = 0; i < period - 1; i++) {
+        ou[i] = 0.0;
+    }
+}
+
+void lv_indicator_macd(size_t fast, size_t slow, size_t signal, size_t sz, const double *in,
+                       double *macd, double *sig, double *hist) {
+    LV_TRACE_SPAN("lv_indicator_macd");
+    assert(fast > 0 && fast < slow && signal > 0 && slow + signal - 1 < sz);
+
+    // hist doubles as scratch for the slow average
+    lv_indicator_ema(fast, sz, in, macd);
+    lv_indicator_ema(slow, sz, in, hist);
+    for (size_t i = slow - 1; i < sz; i++) macd[i] -= hist[i];
+    for (size_t i = 0; i < slow - 1; i++) macd[i] = 0.0;
+
+    // signal line starts once macd itself is valid
+    lv_indicator_ema(signal, sz - (slow - 1), macd + slow - 1, sig + slow - 1);
+    for (size_t i = 0; i < slow - 1; i++) sig[i] = 0.0;
+
+    const size_t warmup = slow + signal - 2;
+    for (size_t i = 0; i < sz; i++) {
+        hist[i] = i < warmup ? 0.0 : macd[i] - sig[i];
+    }
+}
+
+void lv_indicator_rsi(size_t period, size_t sz, const double *in, double *ou) {
+    LV_TRACE_SPAN("lv_indicator_rsi");
+    assert(period > 0 && period < sz);
+
+    double gain = 0.0, loss = 0.0;
+    for (size_t i = 1; i <= period; i++) {
+        double d = in[i] - in[i - 1];
+        if (d > 0) gain += d; else loss -= d;
+    }
+    gain /= (double)period;
+    loss /= (double)period;
+    ou[period] = loss == 0.0 ? 100.0 : 100.0 - 100.0 / (1.0 + gain / loss);
+
+    // Wilder smoothing
+    for (size_t i = period + 1; i < sz; i++) {
+        double d = in[i] - in[i - 1];
+        gain = (gain * (double)(period - 1) + (d > 0 ? d : 0.0)) / (double)period;
+        loss = (loss * (double)(period - 1) + (d < 0 ? -d : 0.0)) / (double)period;
+        ou[i] = loss == 0.0 ? 100.0 : 100.0 - 100.0 / (1.0 + gain / loss);
+    }
+
+    for (size_t i = 0; i < period; i++) {
+        ou[i] = 0.0;
+    }
+}
+
+void lv_indicator_stream_init(lv_indicator_stream *s, size_t ma_window, size_t fast, size_t slow, size_t signal, size_t rsi_period) {
+    assert(ma_window > 0 && fast > 0 && fast < slow && signal > 0 && rsi_period > 0);
+    memset(s, 0, sizeof(*s));
+    s->ma_window = ma_window;
+    s->macd_fast = fast;
+    s->macd_slow = slow;
+    s->macd_signal = signal;
+    s->rsi_period = rsi_period;
+}
+
+// Same operations in the same order as the batch loops, bar by bar.
+void lv_indicator_stream_update(lv_indicator_stream *s, size_t sz, const double *in,
+                                double *ma, double *macd, double *sig, double *hist, double *rsi) {
+    const size_t w = s->ma_window, fast = s->macd_fast, slow = s->macd_slow, signal = s->macd_signal, period = s->rsi_period;
+    const double k_fast = 2.0 / (double)(fast + 1), k_slow = 2.0 / (double)(slow + 1), k_signal = 2.0 / (double)(signal + 1);
+    const size_t warmup = slow + signal - 2;
+    for (size_t i = s->size; i < sz; i++) {
+        const double x = in[i];
+
+        if (i < w) {
+            s->ma_sum += x;
+            ma[i] = i == w - 1 ? s->ma_sum / (double)w : 0.0;
+        } else {
+            s->ma_sum += x - in[i - w];
+            ma[i] = s->ma_sum / (double)w;
+        }
+
+        if (i < fast) s->fast_ema += x;
+        if (i == fast - 1) s->fast_ema /= (double)fast;
+        else if (i >= fast) s->fast_ema += k_fast * (x - s->fast_ema);
+        if (i < slow) s->slow_ema += x;
+        if (i == slow - 1) s->slow_ema /= (double)slow;
+        else if (i >= slow) s->slow_ema += k_slow * (x - s->slow_ema);
+        macd[i] = i < slow - 1 ? 0.0 : s->fast_ema - s->slow_ema;
+        if (i >= slow - 1) {
+            if (i < warmup) s->signal_ema += macd[i];
+            else if (i == warmup) s->signal_ema = (s->signal_ema + macd[i]) / (double)signal;
+            else s->signal_ema += k_signal * (macd[i] - s->signal_ema);
+        }
+        sig[i] = i < warmup ? 0.0 : s->signal_ema;
+        hist[i] = i < warmup ? 0.0 : macd[i] - sig[i];
+
+        if (i > 0 && i <= period) {
+            double d = x - in[i - 1];
+            if (d > 0) s->gain += d; else s->loss -= d;
+            if (i == period) {
+                s->gain /= (double)period;
+                s->loss /= (double)period;
+            }
+        } else if (i > period) {
+            double d = x - in[i - 1];
+            s->gain = (s->gain * (double)(period - 1) + (d > 0 ? d : 0.0)) / (double)period;
+            s->loss = (s->loss * (double)(period - 1) + (d < 0 ? -d : 0.0)) / (double)period;
+        }
+        rsi[i] = i < period ? 0.0 : s->loss == 0.0 ? 100.0 : 100.0 - 100.0 / (1.0 + s->gain / s->loss);
+    }
+    s->size = sz;
+}
+
+void lv_prefix_sum(size_t sz, const double *in, double *ou) {
+    double sum = 0.0;
+    ou[0] = 0.0;
+    for (size_t i = 0; i < sz; i++) {
+        sum += in[i];
+        ou[i + 1] = sum;
+    }
+}
+
+#ifdef LV_TRACE
+#define LV_TRACE_EVENTS 65536 // per thread, power of two
+
+typedef struct lv_trace_event {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+} lv_trace_event;
+
+// One per thread that ever recorded a span. Only the owning thread writes
+// events; head is published with release so a dump can read up to it while
+// the thread keeps running. Buffers are never freed so a dump at exit still
+// sees threads that have finished.
+typedef struct lv_trace_buffer {
+    struct lv_trace_buffer *next;
+    const char *thread_name;
+    int tid;
+    std::atomic<uint64_t> head;
+    lv_trace_event events[LV_TRACE_EVENTS];
+} lv_trace_buffer;
+
+static std::atomic<lv_trace_buffer *> trace_buffers(NULL);
+static std::atomic<int> trace_tids(0);
+static std::once_flag trace_calibration;
+static std::atomic<bool> trace_calibrated(false);   // published after the epoch is written
+static uint64_t trace_epoch_ticks, trace_epoch_ns;
+static thread_local lv_trace_buffer *trace_local = NULL;
+
+static uint64_t trace_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void trace_calibrate(void) {
+    trace_epoch_ns = trace_clock_ns();
+    trace_epoch_ticks = lv_trace_now();
+    trace_calibrated.store(true, std::memory_order_release);
+}
+
+// Other threads registering meanwhile wait in call_once, so no buffer is
+// published before the epoch its timestamps are relative to.
+static lv_trace_buffer * trace_register(void) {
+    std::call_once(trace_calibration, trace_calibrate);
+    lv_trace_buffer *b = (lv_trace_buffer *)calloc(1, sizeof(lv_trace_buffer));
+    if (!b) return NULL;
+    b->tid = trace_tids.fetch_add(1, std::memory_order_relaxed) + 1;
+    b->next = trace_buffers.load(std::memory_order_relaxed);
+    while (!trace_buffers.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) {}
+    trace_local = b;
+    return b;
+}
+
+void lv_trace_record(const char *name, uint64_t start, uint64_t end) {
+    lv_trace_buffer *b = trace_local ? trace_local : trace_register();
+    if (!b) return;
+    uint64_t h = b->head.load(std::memory_order_relaxed);
+    lv_trace_event *e = &b->events[h & (LV_TRACE_EVENTS - 1)];
+    e->name = name;
+    e->start = start;
+    e->end = end;
+    b->head.store(h + 1, std::memory_order_release);
+}
+
+void lv_trace_thread_name(const char *name) {
+    lv_trace_buffer *b = trace_local ? trace_local : trace_register();
+    if (b) b->thread_name = name;
+}
+
+int lv_trace_dump(const char *path) {
+    FILE *fs = fopen(path, "w");
+    if (!fs) return -1;
+
+    // Tick rate from the span of time the tracer has been running.
+    double us_per_tick = 1e-3;
+    uint64_t now_ticks = lv_trace_now(), now_ns = trace_clock_ns();
+    if (trace_calibrated.load(std::memory_order_acquire) && now_ticks > trace_epoch_ticks && now_ns > trace_epoch_ns)
+        us_per_tick = (double)(now_ns - trace_epoch_ns) * 1e-3 / (double)(now_ticks - trace_epoch_ticks);
+
+    int pid = (int)getpid();
+    lv_trace_event *copy = (lv_trace_event *)malloc(sizeof(lv_trace_event) * LV_TRACE_EVENTS);
+    if (!copy) {
+        fclose(fs);
+        return -1;
+    }
+    fprintf(fs, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    const char *sep = "";
+    for (lv_trace_buffer *b = trace_buffers.load(std::memory_order_acquire); b; b = b->next) {
+        if (b->thread_name) {
+            fprintf(fs, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    sep, pid, b->tid, b->thread_name);
+            sep = ",\n";
+        }
+        uint64_t hi = b->head.load(std::memory_order_acquire);
+        uint64_t first = hi > LV_TRACE_EVENTS ? hi - LV_TRACE_EVENTS : 0;
+        for (uint64_t i = first; i < hi; i++)
+            copy[i - first] = b->events[i & (LV_TRACE_EVENTS - 1)];
+        // The owner keeps writing; slots it may have wrapped onto during the
+        // copy (including the one in flight) are dropped.
+        uint64_t after = b->head.load(std::memory_order_acquire);
+        uint64_t lo = after + 1 > first + LV_TRACE_EVENTS ? min(hi, after + 1 - LV_TRACE_EVENTS) : first;
+        for (uint64_t i = lo; i < hi; i++) {
+            const lv_trace_event *e = &copy[i - first];
+            fprintf(fs, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    sep, e->name, pid, b->tid,
+                    (double)(int64_t)(e->start - trace_epoch_ticks) * us_per_tick,
+                    (double)(e->end - e->start) * us_per_tick);
+            sep = ",\n";
+        }
+    }
+    fprintf(fs, "\n]}\n");
+    free(copy);
+    return fclose(fs) == 0 ? 0 : -1;
 }
-#endif
\ No newline at end of file
+#endif // LV_TRACE
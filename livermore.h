@@ -17,6 +17,96 @@ typedef struct lv_candles {
 
 extern void lv_candles_init (lv_candles *candles, size_t sz);
 extern void lv_candles_free (lv_candles *candles);
+// Adds one bar at the end, the path live updates take. Returns -1 when full.
+extern int  lv_candles_append(lv_candles *candles, time_t timestamp, double open, double high, double low, double close, uint64_t volume);
 extern int  lv_candles_fetch(lv_candles *candles, const char *market, const char *symbol, const char *interval);
+// Deterministic synthetic OHLCV series of n <= cap bars, also served as the
+// "synth" market (seeded by the symbol, filling cap bars).
+extern int  lv_candles_synth(lv_candles *candles, uint64_t seed, const char *interval, size_t n);
+
+// The "replay" market serves bodies from <dir>/<symbol>_<interval>.json; with
+// record set, live fetches save their responses there. Configure before any
+// fetch starts; dir must stay valid.
+typedef struct lv_replay_config {
+    const char *dir;
+    unsigned latency_ms;        // added to every replayed fetch
+    size_t bytes_per_sec;       // simulated bandwidth, 0 for memory speed
+    int record;
+} lv_replay_config;
+
+extern void lv_replay_configure(const lv_replay_config *config);
+
+// Scheme and authority the "sina" market fetches from, e.g. "http://127.0.0.1:8080"
+// for a local stand-in. Set before any fetch starts; host must stay valid.
+extern void lv_sina_set_host(const char *host);
+
+// Indicators. Outputs are aligned with the input; warm-up slots are zeroed.
+extern void lv_indicator_ma  (size_t winsz, size_t sz, const double *in, double *ou);
+extern void lv_indicator_ema (size_t period, size_t sz, const double *in, double *ou);
+extern void lv_indicator_macd(size_t fast, size_t slow, size_t signal, size_t sz, const double *in,
+                              double *macd, double *sig, double *hist);
+extern void lv_indicator_rsi (size_t period, size_t sz, const double *in, double *ou);
+
+// Streaming MA, MACD and RSI over a growing series. Each update extends the
+// outputs over the bars added since the last one, carrying the running sums
+// and averages along, so appending k bars costs O(k) whatever the length.
+// The values, including the zeroed warm-up slots, match the batch functions.
+typedef struct lv_indicator_stream {
+    size_t ma_window;
+    size_t macd_fast, macd_slow, macd_signal;
+    size_t rsi_period;
+    size_t size;                // bars consumed
+    double ma_sum;
+    double fast_ema, slow_ema, signal_ema;  // seed sums during warm-up
+    double gain, loss;
+} lv_indicator_stream;
+
+extern void lv_indicator_stream_init  (lv_indicator_stream *s, size_t ma_window, size_t fast, size_t slow, size_t signal, size_t rsi_period);
+extern void lv_indicator_stream_update(lv_indicator_stream *s, size_t sz, const double *in,
+                                       double *ma, double *macd, double *sig, double *hist, double *rsi);
+
+// Prefix sums (sz + 1 entries, ou[0] = 0) shared by many readers: the moving
+// average of any window is then one subtraction per bar, so a sweep over
+// windows reads one array per series instead of computing one per window.
+extern void lv_prefix_sum(size_t sz, const double *in, double *ou);
+
+// Tracing. Spans are recorded as complete events into a per-thread ring of
+// LV_TRACE_EVENTS entries and written out as Chrome trace_event JSON, viewable
+// in chrome://tracing or ui.perfetto.dev. Span and thread names must outlive
+// the dump (string literals). Timestamps are raw TSC ticks on x86 and are
+// converted to microseconds when dumping. Build with -DLV_TRACE to compile
+// the tracer in; otherwise none of it is built and the macros expand to nothing.
+#ifdef LV_TRACE
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t lv_trace_now(void) { return __rdtsc(); }
+#else
+static inline uint64_t lv_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+extern void lv_trace_record(const char *name, uint64_t start, uint64_t end);
+extern void lv_trace_thread_name(const char *name);
+extern int  lv_trace_dump(const char *path);
+#endif
+
+#if defined(LV_TRACE) && defined(__cplusplus)
+struct lv_trace_scope {
+    const char *name;
+    uint64_t start;
+    explicit lv_trace_scope(const char *n) : name(n), start(lv_trace_now()) {}
+    ~lv_trace_scope() { lv_trace_record(name, start, lv_trace_now()); }
+};
+#define LV_TRACE_CONCAT_(a, b) a##b
+#define LV_TRACE_CONCAT(a, b)  LV_TRACE_CONCAT_(a, b)
+#define LV_TRACE_SPAN(name)    lv_trace_scope LV_TRACE_CONCAT(lv_trace_span_, __LINE__)(name)
+#define LV_TRACE_THREAD(name)  lv_trace_thread_name(name)
+#else
+#define LV_TRACE_SPAN(name)
+#define LV_TRACE_THREAD(name)
+#endif
 
 #endif //LIVERMORE_H